@@ -0,0 +1,912 @@
+#include "stdafx.h"
+#include "CppUnitTest.h"
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <atomic>
+#include <algorithm>
+#include <fstream>
+#include <filesystem>
+#include <random>
+
+#include "forward.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace forward
+{
+    namespace
+    {
+        template <typename Action>
+        double milliseconds(Action action)
+        {
+            auto start = std::chrono::steady_clock::now();
+            action();
+            auto end = std::chrono::steady_clock::now();
+            return std::chrono::duration<double, std::milli>(end - start).count();
+        }
+
+        void report(const std::string& name, double ms)
+        {
+            Logger::WriteMessage((name + ": " + std::to_string(ms) + " ms").c_str());
+        }
+
+        void report_bandwidth(const std::string& name, size_t bytes, double ms)
+        {
+            Logger::WriteMessage((name + ": " + std::to_string(bytes / ms / 1e6) + " GB/s").c_str());
+        }
+
+        // Keeps a result observable, so that Release builds, where asserts are compiled out, 
+        // cannot drop the work that computes it. Call it inside the measured action.
+        template <typename T>
+        void keep_alive(const T& value)
+        {
+            if constexpr (std::is_arithmetic_v<T>)
+            {
+                static volatile T kept;
+                kept = value;
+            }
+            else
+            {
+                static const void* volatile address;
+                static volatile size_t size;
+                address = &value;
+                if constexpr (details::has_size<T>::value)
+                    size = value.size();
+            }
+        }
+
+        // Size of the inputs of the throughput benchmarks
+        const int large_size = 10000000;
+
+        // A type whose default constructor costs as much as its other constructors
+        struct Heavy
+        {
+            static inline int default_constructions = 0;
+
+            Heavy() : payload(256, ' ') { ++default_constructions; }
+            explicit Heavy(char c) : payload(256, c) {}
+
+            std::string payload;
+        };
+
+        // An enumerator over a container that uses the original tuple<bool, T> protocol
+        template <typename Container>
+        class TupleProtocolEnumerable
+        {
+        public:
+
+            static const bool is_enumerable = true;
+
+            class enumerator
+            {
+            public:
+
+                enumerator(typename Container::const_iterator begin, typename Container::const_iterator end) :
+                    _current(begin),
+                    _end(end)
+                {}
+
+                auto next()
+                {
+                    using stored_type = typename Container::value_type;
+
+                    if (_current == _end)
+                        return yield_break<stored_type>();
+                    else
+                        return yield_return(stored_type(*_current++));
+                }
+
+            private:
+
+                typename Container::const_iterator _current;
+                typename Container::const_iterator _end;
+            };
+
+            TupleProtocolEnumerable(const Container& container) :
+                _container(container)
+            {}
+
+            enumerator get_enumerator() const
+            {
+                return enumerator(_container.begin(), _container.end());
+            }
+
+        private:
+
+            const Container& _container;
+        };
+    }
+
+    TEST_CLASS(Benchmarks)
+    {
+    public:
+
+        // Many short pipelines over a heavy type, where the end of each stream is a significant part of the work
+        TEST_METHOD(EndOfStreamCost)
+        {
+            const int repetitions = 100000;
+            std::vector<Heavy> input{ Heavy('a'), Heavy('b') };
+            auto keep = [](const Heavy&) { return true; };
+            auto copy = [](const Heavy& h) { return h; };
+
+            size_t total = 0;
+            Heavy::default_constructions = 0;
+            auto tuple_time = milliseconds([&]
+            {
+                for (int i = 0; i < repetitions; ++i)
+                    total += (TupleProtocolEnumerable<std::vector<Heavy>>(input) >> where(keep) >> select(copy) >> to_vector<Heavy>()).size();
+                keep_alive(total);
+            });
+            auto tuple_default_constructions = Heavy::default_constructions;
+
+            Heavy::default_constructions = 0;
+            auto optional_time = milliseconds([&]
+            {
+                for (int i = 0; i < repetitions; ++i)
+                    total += (from(input) >> where(keep) >> select(copy) >> to_vector<Heavy>()).size();
+                keep_alive(total);
+            });
+            auto optional_default_constructions = Heavy::default_constructions;
+
+            report("EndOfStreamCost, tuple protocol", tuple_time);
+            report("EndOfStreamCost, optional protocol", optional_time);
+            Logger::WriteMessage(("EndOfStreamCost, default constructions: tuple protocol " + std::to_string(tuple_default_constructions)
+                + ", optional protocol " + std::to_string(optional_default_constructions)).c_str());
+
+            assert(total == 4 * repetitions);
+            assert(tuple_default_constructions == repetitions);
+            assert(optional_default_constructions == 0);
+        }
+
+        // from(v) >> where(f) >> select(g) >> sum_from(0), driven by the source, versus a hand-written loop 
+        // and versus pulling through the enumerators
+        TEST_METHOD(PushVersusRawLoop)
+        {
+            std::vector<int> v(large_size);
+            for (int i = 0; i < large_size; ++i)
+                v[i] = i % 1000;
+
+            auto filter = [](int i) { return i % 3 != 0; };
+            auto transform = [](int i) { return static_cast<long long>(i) * 2; };
+
+            long long raw = 0;
+            auto raw_time = milliseconds([&]
+            {
+                for (int i : v)
+                    if (filter(i))
+                        raw += transform(i);
+                keep_alive(raw);
+            });
+
+            long long pushed = 0;
+            auto push_time = milliseconds([&]
+            {
+                pushed = from(v) >> where(filter) >> select(transform) >> sum_from(0LL);
+                keep_alive(pushed);
+            });
+
+            long long pulled = 0;
+            auto pull_time = milliseconds([&]
+            {
+                auto enumerator = (from(v) >> where(filter) >> select(transform)).get_enumerator();
+                for (auto next = enumerator.next(); has_more(next); next = enumerator.next())
+                    pulled += get_value_by_ref(next);
+                keep_alive(pulled);
+            });
+
+            report("PushVersusRawLoop, raw loop", raw_time);
+            report("PushVersusRawLoop, push", push_time);
+            report("PushVersusRawLoop, pull", pull_time);
+
+            assert(pushed == raw);
+            assert(pulled == raw);
+        }
+
+        // range(...) >> select(...) >> sum, pulled one element at a time versus pulled in batches
+        TEST_METHOD(BatchesVersusNext)
+        {
+            auto numbers = range(0, large_size);
+            auto square = [](int i) { return static_cast<double>(i) * i; };
+            auto squares = numbers >> select(square);
+
+            double single = 0;
+            auto single_time = milliseconds([&]
+            {
+                // Adding into a local rather than into the captured result, which could alias the buffer below
+                double total = 0;
+                auto enumerator = squares.get_enumerator();
+                for (auto next = enumerator.next(); has_more(next); next = enumerator.next())
+                    total += get_value_by_ref(next);
+                single = total;
+                keep_alive(single);
+            });
+
+            double batched = 0;
+            auto batched_time = milliseconds([&]
+            {
+                double total = 0;
+                auto enumerator = squares.get_enumerator();
+                std::vector<double> buffer(batch_size);
+                for (size_t count; (count = next_batch(enumerator, buffer.data(), batch_size)) != 0;)
+                {
+                    for (size_t i = 0; i < count; ++i)
+                        total += buffer[i];
+                }
+                batched = total;
+                keep_alive(batched);
+            });
+
+            report("BatchesVersusNext, next", single_time);
+            report("BatchesVersusNext, next_batch", batched_time);
+
+            assert(single == batched);
+        }
+
+        // from(v) >> where(f) >> select(g) >> parallel(), on pools of 1, 2, 4... up to the number of cores
+        TEST_METHOD(ParallelScaling)
+        {
+            std::vector<double> v(large_size);
+            for (int i = 0; i < large_size; ++i)
+                v[i] = i % 1000;
+
+            auto filter = [](double d) { return d > 100; };
+            auto transform = [](double d) { return std::sqrt(d) * std::log(d); };
+
+            auto cores = std::max(1u, std::thread::hardware_concurrency());
+            auto sequential = from(v) >> where(filter) >> select(transform) >> to_vector<double>();
+
+            for (unsigned threads = 1; threads <= cores; threads = threads < cores && threads * 2 > cores ? cores : threads * 2)
+            {
+                ThreadPool pool(threads);
+
+                std::vector<double> result;
+                auto vector_time = milliseconds([&]
+                {
+                    result = from(v) >> where(filter) >> select(transform) >> parallel(pool) >> to_vector<double>();
+                    keep_alive(result);
+                });
+
+                double sum = 0;
+                auto sum_time = milliseconds([&]
+                {
+                    sum = from(v) >> where(filter) >> select(transform) >> parallel(pool) >> sum_from(0.0);
+                    keep_alive(sum);
+                });
+
+                report("ParallelScaling, to_vector, " + std::to_string(threads) + " threads", vector_time);
+                report("ParallelScaling, sum_from, " + std::to_string(threads) + " threads", sum_time);
+
+                assert(result == sequential);
+                assert(sum > 0);
+            }
+        }
+
+        // A filter whose cost is concentrated on the first eighth of the input:
+        // one static chunk per thread, versus the default splitting of the pool
+        TEST_METHOD(SkewedSelectivity)
+        {
+            auto& pool = ThreadPool::shared();
+            auto numbers = range(0, large_size / 10);
+            auto filter = [](int i)
+            {
+                if (i >= large_size / 80)
+                    return false;
+                double d = i;
+                for (int k = 0; k < 20; ++k)
+                    d = std::sqrt(d + k);
+                return d > 4;
+            };
+            auto selected = numbers >> where(filter);
+
+            size_t static_count = 0;
+            auto static_time = milliseconds([&]
+            {
+                size_t size = selected.source_size();
+                std::atomic<size_t> count(0);
+                pool.parallel_for(size, (size + pool.thread_count()) / (pool.thread_count() + 1), [&](size_t first, size_t last)
+                {
+                    size_t local = 0;
+                    auto sink = [&](int) { ++local; };
+                    selected.push_range(first, last, sink);
+                    count += local;
+                });
+                static_count = count;
+                keep_alive(static_count);
+            });
+
+            size_t stealing_count = 0;
+            auto stealing_time = milliseconds([&]
+            {
+                stealing_count = selected >> select([](int) { return size_t(1); }) >> parallel(pool) >> sum_from(size_t(0));
+                keep_alive(stealing_count);
+            });
+
+            report("SkewedSelectivity, static chunks", static_time);
+            report("SkewedSelectivity, work stealing", stealing_time);
+
+            assert(static_count == stealing_count);
+        }
+
+        // sum_from over contiguous arithmetic sources, with the vectorized kernels versus adding element by element
+        TEST_METHOD(SumBandwidth)
+        {
+            auto measure = [](auto zero, const std::string& type)
+            {
+                using T = decltype(zero);
+                std::vector<T> v(large_size);
+                for (int i = 0; i < large_size; ++i)
+                    v[i] = static_cast<T>(i % 16);
+
+                T generic = 0, vectorized = 0;
+                auto generic_time = milliseconds([&] { generic = details::sum_by_element(from(v), zero); keep_alive(generic); });
+                auto vectorized_time = milliseconds([&] { vectorized = from(v) >> sum_from(zero); keep_alive(vectorized); });
+
+                report_bandwidth("SumBandwidth, " + type + ", element by element", v.size() * sizeof(T), generic_time);
+                report_bandwidth("SumBandwidth, " + type + ", kernels", v.size() * sizeof(T), vectorized_time);
+
+                // Floating point sums of that many elements are rounded differently
+                assert(std::is_floating_point_v<T> ? generic > 0 && vectorized > 0 : generic == vectorized);
+            };
+
+            measure(0.0f, "float");
+            measure(0.0, "double");
+            measure(0, "int");
+            measure(0LL, "long long");
+        }
+
+        // sum_from over a pipeline that can only be pulled, because it ends with take: 
+        // adding the elements one at a time, versus the kernels of sum_array over the batches of the enumerator
+        TEST_METHOD(SumPullOnly)
+        {
+            std::vector<int> v(large_size);
+            for (int i = 0; i < large_size; ++i)
+                v[i] = i % 1000;
+            auto taken = from(v) >> select([](int i) { return static_cast<double>(i); }) >> take(large_size);
+
+            double by_element = 0, batched = 0;
+            auto by_element_time = milliseconds([&] { by_element = details::sum_by_element(taken, 0.0); keep_alive(by_element); });
+            auto batched_time = milliseconds([&] { batched = taken >> sum_from(0.0); keep_alive(batched); });
+
+            report("SumPullOnly, element by element", by_element_time);
+            report("SumPullOnly, kernels over batches", batched_time);
+
+            assert(by_element == batched);
+        }
+
+        // to_vector over from(v) >> select(...): growing the vector one push_back at a time, 
+        // as without size hints, versus reserving once from the hint
+        TEST_METHOD(ReserveFromSizeHint)
+        {
+            std::vector<int> v(large_size);
+            for (int i = 0; i < large_size; ++i)
+                v[i] = i;
+            auto source = from(v);
+            auto widen = [](int i) { return static_cast<double>(i); };
+            auto widened = source >> select(widen);
+
+            std::vector<double> grown;
+            size_t allocations = 0;
+            auto grown_time = milliseconds([&]
+            {
+                for_each(widened, [&](double d)
+                {
+                    auto capacity = grown.capacity();
+                    grown.push_back(d);
+                    allocations += grown.capacity() != capacity;
+                });
+                keep_alive(grown);
+            });
+
+            std::vector<double> reserved;
+            auto reserved_time = milliseconds([&]
+            {
+                reserved = to_vector(widened);
+                keep_alive(reserved);
+            });
+
+            report("ReserveFromSizeHint, " + std::to_string(allocations) + " allocations", grown_time);
+            report("ReserveFromSizeHint, 1 allocation", reserved_time);
+
+            assert(reserved == grown);
+            assert(reserved.capacity() == reserved.size());
+        }
+
+        // Sorting records by a key parsed from them: evaluating the key in every comparison versus once per record
+        TEST_METHOD(OrderByComputedKey)
+        {
+            std::vector<std::string> records(large_size / 10);
+            for (size_t i = 0; i < records.size(); ++i)
+                records[i] = "record;" + std::to_string((i * 7919) % records.size()) + ";payload";
+
+            auto parsed = [](const std::string& record) { return std::stoi(record.substr(record.find(';') + 1)); };
+
+            auto compared = records;
+            auto compared_time = milliseconds([&]
+            {
+                std::sort(compared.begin(), compared.end(), [&](const auto& a, const auto& b)
+                {
+                    return parsed(a) < parsed(b);
+                });
+                keep_alive(compared);
+            });
+
+            std::vector<std::string> cached;
+            auto cached_time = milliseconds([&]
+            {
+                cached = from(records) >> to_vector_ordered_by<std::string>(parsed);
+                keep_alive(cached);
+            });
+
+            report("OrderByComputedKey, key in comparisons", compared_time);
+            report("OrderByComputedKey, cached keys", cached_time);
+
+            assert(cached == compared);
+        }
+
+        // Sorting events by 64 bits timestamp: comparison sort versus radix sort of the cached keys
+        TEST_METHOD(OrderByRadix)
+        {
+            struct Event
+            {
+                std::uint64_t timestamp;
+                std::uint32_t id;
+
+                bool operator == (const Event& other) const { return timestamp == other.timestamp && id == other.id; }
+            };
+
+            std::vector<Event> events(large_size);
+            std::uint64_t state = 88172645463325252ull;
+            for (size_t i = 0; i < events.size(); ++i)
+            {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                events[i] = Event{ 1500000000000000ull + state % 100000000000ull, static_cast<std::uint32_t>(i) };
+            }
+
+            auto timestamp = [](const Event& e) { return e.timestamp; };
+
+            auto compared = events;
+            auto compared_time = milliseconds([&]
+            {
+                std::stable_sort(compared.begin(), compared.end(), [&](const Event& a, const Event& b)
+                {
+                    return timestamp(a) < timestamp(b);
+                });
+                keep_alive(compared);
+            });
+
+            std::vector<Event> radix;
+            auto radix_time = milliseconds([&]
+            {
+                radix = from(events) >> to_vector_ordered_by<Event>(timestamp);
+                keep_alive(radix);
+            });
+
+            report("OrderByRadix, comparison sort", compared_time);
+            report("OrderByRadix, radix sort", radix_time);
+
+            assert(radix == compared);
+        }
+
+        // The 100 best scores out of large_size rows: ordering everything then taking, versus a bounded heap
+        TEST_METHOD(TopK)
+        {
+            std::vector<std::pair<int, double>> rows(large_size);
+            for (int i = 0; i < large_size; ++i)
+                rows[i] = { i, std::fmod(i * 0.6180339887, 1.0) };
+
+            auto score = [](const std::pair<int, double>& row) { return -row.second; };
+            auto source = from(rows);
+
+            std::vector<std::pair<int, double>> sorted;
+            auto sorted_time = milliseconds([&]
+            {
+                auto ordered = source >> order_by<std::pair<int, double>>(score);
+                sorted = ordered >> take(100) >> to_vector<std::pair<int, double>>();
+                keep_alive(sorted);
+            });
+
+            std::vector<std::pair<int, double>> heap;
+            auto heap_time = milliseconds([&]
+            {
+                heap = source >> top_k<std::pair<int, double>>(100, score);
+                keep_alive(heap);
+            });
+
+            report("TopK, order_by then take", sorted_time);
+            report("TopK, top_k", heap_time);
+
+            assert(heap == sorted);
+        }
+
+        // Sums of a field by key, over 10000 keys: a hand-written loop over std::unordered_map versus group_by
+        TEST_METHOD(GroupBySum)
+        {
+            std::vector<std::pair<int, double>> rows(large_size);
+            for (int i = 0; i < large_size; ++i)
+                rows[i] = { static_cast<int>((i * 2654435761u) % 10000), i % 13 * 0.5 };
+
+            std::unordered_map<int, double> hand_written;
+            auto hand_written_time = milliseconds([&]
+            {
+                for (const auto& row : rows)
+                    hand_written[row.first] += row.second;
+                keep_alive(hand_written);
+            });
+
+            auto source = from(rows);
+            auto key = [](const std::pair<int, double>& row) { return row.first; };
+            auto value = [](const std::pair<int, double>& row) { return row.second; };
+
+            FlatHashMap<int, double> grouped;
+            auto group_by_time = milliseconds([&]
+            {
+                grouped = source >> to_groups(key, aggregate_sum(value));
+                keep_alive(grouped);
+            });
+
+            report("GroupBySum, std::unordered_map", hand_written_time);
+            report("GroupBySum, to_groups", group_by_time);
+
+            assert(grouped.size() == hand_written.size());
+            for ([[maybe_unused]] const auto& group : grouped)
+                assert(group.second == hand_written[group.first]);
+        }
+
+        // Sums by key over 100M rows with 1K, 1M and 100M distinct keys, enumerated once aggregated: sequentially, 
+        // and after parallel(), which pre-aggregates every range of the source and merges the partitions of the keys 
+        // on all the threads
+        TEST_METHOD(GroupByScaling)
+        {
+            const int rows = 100000000;
+            auto source = range(0, rows);
+            auto value = aggregate_sum([](int i) { return i & 7; });
+            auto& pool = ThreadPool::shared();
+            auto parallel_source = source >> parallel(pool);
+
+            for (int keys : { 1000, 1000000, 100000000 })
+            {
+                auto key = [keys](int i) { return i % keys; };
+                size_t sequential_count = 0, parallel_count = 0;
+
+                auto sequential_time = milliseconds([&]
+                {
+                    sequential_count = source >> group_by(key, value) >> count();
+                    keep_alive(sequential_count);
+                });
+
+                auto parallel_time = milliseconds([&]
+                {
+                    parallel_count = parallel_source >> group_by(key, value) >> count();
+                    keep_alive(parallel_count);
+                });
+
+                std::string name = "GroupByScaling, " + std::to_string(keys) + " keys, ";
+                report(name + "sequential", sequential_time);
+                report(name + std::to_string(pool.thread_count()) + " threads", parallel_time);
+
+                assert(sequential_count == static_cast<size_t>(keys) && parallel_count == sequential_count);
+            }
+        }
+
+        // 10M events against 100K users, a tenth of the events with an unknown user: 
+        // a hand-built std::unordered_map probed in a loop, versus join and where_not_in
+        TEST_METHOD(HashJoin)
+        {
+            const int users = 100000;
+            std::vector<std::pair<int, double>> weights(users);
+            for (int i = 0; i < users; ++i)
+                weights[i] = { i, i % 3 + 0.5 };
+
+            std::vector<int> events(large_size);
+            for (int i = 0; i < large_size; ++i)
+                events[i] = static_cast<int>((i * 2654435761u) % (users + users / 9));
+
+            double hand_written = 0;
+            size_t hand_written_unknown = 0;
+            auto hand_written_time = milliseconds([&]
+            {
+                std::unordered_map<int, double> by_user;
+                for (const auto& weight : weights)
+                    by_user.emplace(weight.first, weight.second);
+
+                for (int user : events)
+                {
+                    auto found = by_user.find(user);
+                    if (found != by_user.end())
+                        hand_written += found->second;
+                    else
+                        ++hand_written_unknown;
+                }
+                keep_alive(hand_written);
+                keep_alive(hand_written_unknown);
+            });
+
+            auto event_source = from(events);
+            auto user_source = from(weights);
+            auto user_of = [](int user) { return user; };
+            auto id = [](const std::pair<int, double>& weight) { return weight.first; };
+
+            double joined = 0;
+            auto join_time = milliseconds([&]
+            {
+                joined = event_source >> join(user_source, user_of, id, [](int, const std::pair<int, double>& w) { return w.second; }) >> sum_from(0.0);
+                keep_alive(joined);
+            });
+
+            size_t unknown = 0;
+            auto anti_join_time = milliseconds([&]
+            {
+                unknown = event_source >> where_not_in(user_source, user_of, id) >> count();
+                keep_alive(unknown);
+            });
+
+            report("HashJoin, std::unordered_map", hand_written_time);
+            report("HashJoin, join", join_time);
+            report("HashJoin, where_not_in", anti_join_time);
+
+            assert(joined == hand_written && unknown == hand_written_unknown);
+        }
+
+        // Two time series of 10M samples each, sorted by time, joined on equal times: 
+        // hash join, which collects one side into a table, versus merge_join, which streams both
+        TEST_METHOD(MergeJoinSorted)
+        {
+            std::vector<std::pair<long long, double>> trades(large_size), quotes(large_size);
+            for (int i = 0; i < large_size; ++i)
+            {
+                trades[i] = { 2LL * i, i % 7 };
+                quotes[i] = { 3LL * i, i % 5 };
+            }
+
+            auto trade_source = from(trades);
+            auto quote_source = from(quotes);
+            auto time = [](const std::pair<long long, double>& sample) { return sample.first; };
+            auto product = [](const std::pair<long long, double>& t, const std::pair<long long, double>& q) { return t.second * q.second; };
+
+            double hashed = 0;
+            auto hash_time = milliseconds([&]
+            {
+                hashed = trade_source >> join(quote_source, time, time, product) >> sum_from(0.0);
+                keep_alive(hashed);
+            });
+
+            double merged = 0;
+            auto merge_time = milliseconds([&]
+            {
+                merged = trade_source >> assume_ordered_by<std::pair<long long, double>>(time)
+                    >> merge_join(quote_source >> assume_ordered_by<std::pair<long long, double>>(time), product)
+                    >> sum_from(0.0);
+                keep_alive(merged);
+            });
+
+            report("MergeJoinSorted, join", hash_time);
+            report("MergeJoinSorted, merge_join", merge_time);
+
+            assert(merged == hashed);
+        }
+
+        // 1M orders exploded into their 10M line items and summed: a hand-rolled flatten that builds a vector per order,
+        // versus select_many, which enumerates the items of every order in place
+        TEST_METHOD(SelectManyLineItems)
+        {
+            struct Order
+            {
+                std::vector<std::pair<int, double>> lines; // quantity, price
+            };
+            std::vector<Order> orders(large_size / 10);
+            for (size_t i = 0; i < orders.size(); ++i)
+            {
+                for (size_t j = 0; j < 5 + i % 11; ++j)
+                    orders[i].lines.emplace_back(static_cast<int>(j % 3 + 1), (i + j) % 17 * 0.25);
+            }
+
+            auto amounts_of = [](const Order& order)
+            {
+                std::vector<double> amounts;
+                for (const auto& line : order.lines)
+                    amounts.push_back(line.first * line.second);
+                return amounts;
+            };
+
+            double hand_rolled = 0;
+            auto hand_rolled_time = milliseconds([&]
+            {
+                for (const auto& order : orders)
+                {
+                    for (double amount : amounts_of(order))
+                        hand_rolled += amount;
+                }
+                keep_alive(hand_rolled);
+            });
+
+            auto source = from(orders);
+            double flattened = 0;
+            auto select_many_time = milliseconds([&]
+            {
+                flattened = source
+                    >> select_many([](const Order& o) -> const std::vector<std::pair<int, double>>& { return o.lines; })
+                    >> select([](const std::pair<int, double>& line) { return line.first * line.second; })
+                    >> sum_from(0.0);
+                keep_alive(flattened);
+            });
+
+            double pulled = 0;
+            auto pulled_time = milliseconds([&]
+            {
+                auto enumerator = (source >> select_many([](const Order& o) -> const std::vector<std::pair<int, double>>& { return o.lines; })).get_enumerator();
+                for (auto line = enumerator.next(); line; line = enumerator.next())
+                    pulled += line->first * line->second;
+                keep_alive(pulled);
+            });
+
+            report("SelectManyLineItems, vector per order", hand_rolled_time);
+            report("SelectManyLineItems, select_many", select_many_time);
+            report("SelectManyLineItems, select_many pulled", pulled_time);
+
+            assert(flattened == hand_rolled && pulled == hand_rolled);
+        }
+
+        // A dot product of two vectors: a hand-written loop versus zip >> select >> sum_from
+        TEST_METHOD(ZipDotProduct)
+        {
+            std::vector<double> x(large_size), y(large_size);
+            for (int i = 0; i < large_size; ++i)
+            {
+                x[i] = i % 7;
+                y[i] = i % 5;
+            }
+
+            double raw = 0;
+            auto raw_time = milliseconds([&]
+            {
+                for (size_t i = 0; i < x.size(); ++i)
+                    raw += x[i] * y[i];
+                keep_alive(raw);
+            });
+
+            auto x_source = from(x);
+            auto y_source = from(y);
+            auto multiply = [](const auto& t) { return std::get<0>(t) * std::get<1>(t); };
+
+            double zipped = 0;
+            auto zipped_time = milliseconds([&]
+            {
+                zipped = zip(x_source, y_source) >> select(multiply) >> sum_from(0.0);
+                keep_alive(zipped);
+            });
+
+            report("ZipDotProduct, raw loop", raw_time);
+            report("ZipDotProduct, zip", zipped_time);
+
+            assert(zipped == raw);
+        }
+
+        // Total length of the lines of a file of large_size / 10 log lines: std::getline, versus lines() sequential and parallel
+        TEST_METHOD(LinesVersusGetline)
+        {
+            auto path = std::filesystem::temp_directory_path() / "forward-lines-benchmark.log";
+            {
+                std::ofstream file(path, std::ios::binary);
+                for (int i = 0; i < large_size / 10; ++i)
+                    file << "2024-01-01T00:00:00 INFO request " << i << " served in " << i % 997 << " ms\n";
+            }
+
+            size_t getline_total = 0;
+            auto getline_time = milliseconds([&]
+            {
+                std::ifstream file(path, std::ios::binary);
+                for (std::string line; std::getline(file, line);)
+                    getline_total += line.size();
+                keep_alive(getline_total);
+            });
+
+            auto size = [](std::string_view line) { return line.size(); };
+
+            size_t mapped_total = 0;
+            auto mapped_time = milliseconds([&]
+            {
+                mapped_total = lines(path) >> select(size) >> sum_from(size_t(0));
+                keep_alive(mapped_total);
+            });
+
+            size_t parallel_total = 0;
+            auto parallel_time = milliseconds([&]
+            {
+                parallel_total = lines(path) >> select(size) >> parallel() >> sum_from(size_t(0));
+                keep_alive(parallel_total);
+            });
+
+            std::filesystem::remove(path);
+
+            report("LinesVersusGetline, std::getline", getline_time);
+            report("LinesVersusGetline, lines", mapped_time);
+            report("LinesVersusGetline, lines in parallel", parallel_time);
+
+            assert(mapped_total == getline_total);
+            assert(parallel_total == getline_total);
+        }
+
+        // 1000 records sampled from a stream of large_size: a reservoir drawing a random number per element
+        // (Algorithm R), versus sample, which skips elements without producing them
+        TEST_METHOD(SampleFromStream)
+        {
+            std::vector<int> v(large_size);
+            for (int i = 0; i < large_size; ++i)
+                v[i] = i;
+            auto source = from(v);
+            auto record = [](int i) { return std::to_string(i); };
+            auto records = source >> select(record);
+            const size_t k = 1000;
+
+            std::vector<std::string> reservoir;
+            auto per_element_time = milliseconds([&]
+            {
+                std::mt19937_64 generator(1);
+                size_t seen = 0;
+                for_each(records, [&](std::string&& r)
+                {
+                    if (seen < k)
+                    {
+                        reservoir.push_back(std::move(r));
+                    }
+                    else
+                    {
+                        size_t slot = std::uniform_int_distribution<size_t>(0, seen)(generator);
+                        if (slot < k)
+                            reservoir[slot] = std::move(r);
+                    }
+                    ++seen;
+                });
+                keep_alive(reservoir);
+            });
+
+            std::vector<std::string> sampled;
+            auto skipping_time = milliseconds([&]
+            {
+                sampled = records >> sample<std::string>(k, 1);
+                keep_alive(sampled);
+            });
+
+            report("SampleFromStream, per element reservoir", per_element_time);
+            report("SampleFromStream, sample", skipping_time);
+
+            assert(reservoir.size() == k && sampled.size() == k);
+        }
+
+        // to_unordered_set versus to_set over inputs with 1%, 50% and 90% of duplicates,
+        // on large_size ints, and on a tenth as many short strings
+        TEST_METHOD(FlatHashSet)
+        {
+            auto measure = [](auto make, size_t size, const std::string& type)
+            {
+                for (int duplicates : { 1, 50, 90 })
+                {
+                    size_t distinct = std::max<size_t>(1, size * (100 - duplicates) / 100);
+                    std::vector<decltype(make(size_t()))> v;
+                    v.reserve(size);
+                    for (size_t i = 0; i < size; ++i)
+                        v.push_back(make((i * 2654435761u) % distinct));
+
+                    size_t unordered_size = 0, flat_size = 0;
+                    auto unordered_time = milliseconds([&] { unordered_size = (from(v) >> to_unordered_set<decltype(make(size_t()))>()).size(); keep_alive(unordered_size); });
+                    auto flat_time = milliseconds([&] { flat_size = (from(v) >> to_set<decltype(make(size_t()))>()).size(); keep_alive(flat_size); });
+
+                    auto name = "FlatHashSet, " + type + ", " + std::to_string(duplicates) + "% duplicates, ";
+                    report(name + "std::unordered_set", unordered_time);
+                    report(name + "FlatHashSet", flat_time);
+
+                    assert(unordered_size == flat_size);
+                }
+            };
+
+            measure([](size_t i) { return static_cast<int>(i); }, large_size, "int");
+            measure([](size_t i) { return "key-" + std::to_string(i); }, large_size / 10, "string");
+        }
+    };
+}
@@ -4,40 +4,54 @@
 #include <functional>
 #include <cassert>
 #include <vector>
+#include <tuple>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <array>
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+
+#include "forward-simd.h"
 
 namespace forward
 {
     // CONTAINS
-    // select, from, where, range
-    // to_vector, sum_from
+    // select, from, where, range, take, skip, zip, select_many
+    // to_vector, sum_from, for_each, first, single
+    // count, is_empty, exists, forall, unzip
+    // get_size_hint
     //
     // TODO
-    // take, skip, single,
-    // count, is_empty
-    // forall, exists
-    // zip, unzip
     // ways to enumerable on pairs/triples
 
 #pragma region Nullable objects, represented by a tuple<bool, T>
 
     template <typename T>
-    bool has_more(const T& current)
+    bool has_more(const std::tuple<bool, T>& current)
     {
         return std::get<0>(current);
     }
 
     template <typename T>
-    auto get_value_by_ref(const T& current)
+    const T& get_value_by_ref(const std::tuple<bool, T>& current)
     {
         return std::get<1>(current);
     }
 
     template <typename T>
-    auto forward_value(T&& current)
+    T& get_value_by_ref(std::tuple<bool, T>& current)
     {
         return std::get<1>(current);
     }
 
+    template <typename T>
+    T forward_value(std::tuple<bool, T>& current)
+    {
+        return std::move(std::get<1>(current));
+    }
+
     template <typename ReturnType>
     auto yield_break()
     {
@@ -52,6 +66,315 @@ namespace forward
 
 #pragma endregion
 
+#pragma region Nullable objects, represented by a std::optional<T>
+
+    // The end of the stream is an empty optional, so nothing is constructed to signal it 
+    // and the enumerated type does not need to be default-constructible.
+    // All the enumerators of the library use this representation; 
+    // all the accumulators understand both.
+
+    template <typename T>
+    bool has_more(const std::optional<T>& current)
+    {
+        return current.has_value();
+    }
+
+    template <typename T>
+    const T& get_value_by_ref(const std::optional<T>& current)
+    {
+        return *current;
+    }
+
+    template <typename T>
+    T& get_value_by_ref(std::optional<T>& current)
+    {
+        return *current;
+    }
+
+    template <typename T>
+    T forward_value(std::optional<T>& current)
+    {
+        return std::move(*current);
+    }
+
+    template <typename ReturnType>
+    std::optional<ReturnType> yield_none()
+    {
+        return std::nullopt;
+    }
+
+    template <typename ReturnType>
+    auto yield_some(ReturnType&& current)
+    {
+        return std::optional<std::decay_t<ReturnType>>(std::forward<ReturnType>(current));
+    }
+
+#pragma endregion
+
+#pragma region Enumerated types
+
+    template <typename Nullable>
+    struct nullable_traits;
+
+    template <typename T>
+    struct nullable_traits<std::tuple<bool, T>>
+    {
+        using value_type = T;
+    };
+
+    template <typename T>
+    struct nullable_traits<std::optional<T>>
+    {
+        using value_type = T;
+    };
+
+    // The type of the values returned by the next() method of an enumerator, 
+    // whichever of the two nullable representations it uses
+    template <typename Enumerator>
+    using enumerated_type = typename nullable_traits<
+        std::decay_t<decltype(std::declval<Enumerator&>().next())>>::value_type;
+
+#pragma endregion
+
+#pragma region Batches
+
+    // Enumerators can optionally produce several values at once:
+    /*
+
+    // Writes up to capacity next values into the buffer, and returns how many were written.
+    // Returns zero only at the end of the enumeration.
+    size_t next_batch(Return_type* buffer, size_t capacity);
+
+    */
+    // This amortizes the call overhead of the stages over a whole batch, 
+    // and gives loops over plain arrays that the compiler can vectorize.
+
+    // The size of the batches used by the stages of the library
+    const size_t batch_size = 1024;
+
+    // The types that the stages make batches of themselves. Their buffers are left uninitialized, 
+    // so that no element is constructed only to be overwritten, and stay small enough to live on the stack.
+    template <typename T>
+    constexpr bool is_batchable = std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T> && sizeof(T) <= 16;
+
+    namespace details
+    {
+        template <typename Enumerator, typename = void>
+        struct has_next_batch : std::false_type {};
+
+        template <typename Enumerator>
+        struct has_next_batch<Enumerator, std::void_t<decltype(
+            std::declval<Enumerator&>().next_batch(std::declval<enumerated_type<Enumerator>*>(), size_t()))>> : std::true_type {};
+    }
+
+    // Fills a batch from any enumerator, falling back to next() if it does not produce batches itself.
+    // The fallback relies on enumerators returning the end again once they have reached it.
+    template <typename Enumerator, typename T>
+    size_t next_batch(Enumerator& enumerator, T* buffer, size_t capacity)
+    {
+        if constexpr (details::has_next_batch<Enumerator>::value)
+        {
+            return enumerator.next_batch(buffer, capacity);
+        }
+        else
+        {
+            size_t count = 0;
+            for (; count < capacity; ++count)
+            {
+                auto&& next = enumerator.next();
+                if (!has_more(next))
+                    break;
+                buffer[count] = forward_value(next);
+            }
+            return count;
+        }
+    }
+
+#pragma endregion
+
+#pragma region Internal iteration
+
+    // Enumerables can optionally drive the enumeration themselves, calling a sink on every element:
+    /*
+
+    template <typename Sink>
+    void push_to(Sink& sink) const;
+
+    */
+    // A chain of stages that all implement push_to inlines into a single loop over the source.
+    // Sinks are called either with an lvalue that they must not modify, or with an rvalue that they own.
+
+    namespace details
+    {
+        struct ProbeSink
+        {
+            template <typename T>
+            void operator()(T&&) const {}
+        };
+
+        template <typename Enumerable, typename = void>
+        struct has_push_to : std::false_type {};
+
+        template <typename Enumerable>
+        struct has_push_to<Enumerable, std::void_t<decltype(
+            std::declval<const Enumerable&>().push_to(std::declval<ProbeSink&>()))>> : std::true_type {};
+    }
+
+    // Calls the action on every element of the enumerable, 
+    // driven by the enumerable itself if it supports it, and otherwise by pulling from its enumerator.
+    template <typename Enumerable, typename Action>
+    void for_each(const Enumerable& enumerable, Action&& action)
+    {
+        static_assert(Enumerable::is_enumerable, "Oops.");
+
+        if constexpr (details::has_push_to<Enumerable>::value)
+        {
+            enumerable.push_to(action);
+        }
+        else
+        {
+            auto enumerator = enumerable.get_enumerator();
+            using enumerator_type = decltype(enumerator);
+            using value_type = enumerated_type<enumerator_type>;
+
+            if constexpr (details::has_next_batch<enumerator_type>::value && is_batchable<value_type>)
+            {
+                std::array<value_type, batch_size> buffer;
+                for (size_t count; (count = enumerator.next_batch(buffer.data(), batch_size)) != 0;)
+                {
+                    for (size_t i = 0; i < count; ++i)
+                        action(std::move(buffer[i]));
+                }
+            }
+            else
+            {
+                for (;;)
+                {
+                    auto&& next = enumerator.next();
+                    if (!has_more(next))
+                        return;
+                    action(forward_value(next));
+                }
+            }
+        }
+    }
+
+    // Enumerables over sources with random access can also be split, 
+    // pushing only the elements at a range of positions of their source:
+    /*
+
+    size_t source_size() const;
+
+    template <typename Sink>
+    void push_range(size_t first, size_t last, Sink& sink) const;
+
+    */
+    // Stages that keep no state between elements, such as where and select, are splittable when their upstream is.
+    // Positions are those of the source: a split where may push fewer than (last - first) elements.
+
+    template <typename Iterator>
+    constexpr bool is_random_access = std::is_base_of_v<
+        std::random_access_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>;
+
+    namespace details
+    {
+        template <typename Enumerable, typename = void>
+        struct is_splittable : std::false_type {};
+
+        template <typename Enumerable>
+        struct is_splittable<Enumerable, std::void_t<decltype(
+            std::declval<const Enumerable&>().source_size())>> : std::true_type {};
+    }
+
+#pragma endregion
+
+#pragma region Size hints
+
+    // Enumerables can optionally tell how many elements they produce, 
+    // so that accumulators can allocate their result once:
+    /*
+
+    std::optional<SizeHint> size_hint() const;
+
+    */
+
+    struct SizeHint
+    {
+        // The exact number of elements if is_exact, and otherwise an upper bound on it
+        size_t size;
+        bool is_exact;
+    };
+
+    namespace details
+    {
+        template <typename Enumerable, typename = void>
+        struct has_size_hint : std::false_type {};
+
+        template <typename Enumerable>
+        struct has_size_hint<Enumerable, std::void_t<decltype(
+            std::declval<const Enumerable&>().size_hint())>> : std::true_type {};
+
+        template <typename Container, typename = void>
+        struct has_size : std::false_type {};
+
+        template <typename Container>
+        struct has_size<Container, std::void_t<decltype(
+            std::declval<const Container&>().size())>> : std::true_type {};
+    }
+
+    // The size hint of any enumerable, or nothing if it does not give one
+    template <typename Enumerable>
+    std::optional<SizeHint> get_size_hint(const Enumerable& enumerable)
+    {
+        if constexpr (details::has_size_hint<Enumerable>::value)
+            return enumerable.size_hint();
+        else
+            return std::nullopt;
+    }
+
+    // The same hint, as an upper bound
+    inline std::optional<SizeHint> at_most(std::optional<SizeHint> hint)
+    {
+        if (hint)
+            hint->is_exact = false;
+        return hint;
+    }
+
+    // How many elements an accumulator reserves from a hint. Only exact hints are reserved: 
+    // an upper bound, such as that of a selective filter, can be far larger than the result.
+    inline size_t reserved_size(const std::optional<SizeHint>& hint)
+    {
+        return hint && hint->is_exact ? hint->size : 0;
+    }
+
+#pragma endregion
+
+#pragma region Reverse enumeration
+
+    // Enumerables can optionally enumerate their elements backwards, without collecting them first:
+    /*
+
+    auto get_reverse_enumerator() const;
+
+    */
+    // Integral ranges and bidirectional iteratables implement it, and where and select forward it to their upstream.
+
+    template <typename Iterator>
+    constexpr bool is_bidirectional = std::is_base_of_v<
+        std::bidirectional_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>;
+
+    namespace details
+    {
+        template <typename Enumerable, typename = void>
+        struct has_reverse_enumerator : std::false_type {};
+
+        template <typename Enumerable>
+        struct has_reverse_enumerator<Enumerable, std::void_t<decltype(
+            std::declval<const Enumerable&>().get_reverse_enumerator())>> : std::true_type {};
+    }
+
+#pragma endregion
+
 #pragma region Enumerators
 
     // Enumerators are conceptually as follows. 
@@ -59,17 +382,47 @@ namespace forward
     // 
     /*
 
-    template <typename Return_type> // Not the actual paramaterization. ReturnType needs to be default constructible
+    template <typename Return_type>
     struct AbstractEnumerator
     {
-        // Returns (true, next calculated value),
-        // Or, if no next value exists: (false, default_coonstructor())
-        std::tuple<bool, Return_type> next();
+        // Returns the next calculated value,
+        // Or, if no next value exists: an empty optional
+        std::optional<Return_type> next();
     };
 
+    // The original protocol, where next() returns (true, next calculated value), 
+    // or (false, default_constructor()) at the end, is still accepted everywhere. 
+    // It requires Return_type to be default constructible.
+
     */
 
 
+    namespace details
+    {
+        // The distance and the moves between integers are computed in the unsigned type,
+        // so that ranges wider than the largest value of a signed type, such as range(INT_MIN, INT_MAX), do not overflow
+        template <typename Number>
+        size_t integer_distance(Number first, Number last)
+        {
+            using unsigned_type = std::make_unsigned_t<Number>;
+            return static_cast<size_t>(static_cast<unsigned_type>(static_cast<unsigned_type>(last) - static_cast<unsigned_type>(first)));
+        }
+
+        template <typename Number>
+        Number integer_advance(Number number, size_t count)
+        {
+            using unsigned_type = std::make_unsigned_t<Number>;
+            return static_cast<Number>(static_cast<unsigned_type>(static_cast<unsigned_type>(number) + static_cast<unsigned_type>(count)));
+        }
+
+        template <typename Number>
+        Number integer_retreat(Number number, size_t count)
+        {
+            using unsigned_type = std::make_unsigned_t<Number>;
+            return static_cast<Number>(static_cast<unsigned_type>(static_cast<unsigned_type>(number) - static_cast<unsigned_type>(count)));
+        }
+    }
+
     // An enumerator that returns elements by value within a range.
     // Implements:
     //
@@ -93,9 +446,35 @@ namespace forward
         auto next()
         {
             if (_current == _lastExcluded)
-                return yield_break<Number>();
+                return yield_none<Number>();
+            else
+                return yield_some<Number>(_current++);
+        }
+
+        // The bounds are copied to locals, as the writes through the buffer could otherwise alias them
+        size_t next_batch(Number* buffer, size_t capacity)
+        {
+            Number current = _current;
+            const Number last = _lastExcluded;
+            size_t count = 0;
+            for (; count < capacity && current != last; ++count)
+                buffer[count] = current++;
+            _current = current;
+            return count;
+        }
+
+        void skip(size_t count)
+        {
+            if constexpr (std::is_integral_v<Number>)
+            {
+                size_t remaining = _current < _lastExcluded ? details::integer_distance(_current, _lastExcluded) : 0;
+                _current = details::integer_advance(_current, std::min(count, remaining));
+            }
             else
-                return yield_return<Number>(_current++);
+            {
+                for (; count != 0 && _current != _lastExcluded; --count)
+                    ++_current;
+            }
         }
 
     private:
@@ -105,6 +484,51 @@ namespace forward
     };
 
 
+    // for (Number i = lastExcluded; i != start; )
+    // {
+    //     yield return --i;
+    // } 
+    //
+    template <typename Number>
+    class ReverseRangeEnumerator
+    {
+    public:
+
+        static const bool is_enumerator = true;
+
+        ReverseRangeEnumerator(Number start, Number lastExcluded) :
+            _start(start),
+            _current(start < lastExcluded ? lastExcluded : start)
+        {}
+
+        auto next()
+        {
+            if (_current == _start)
+                return yield_none<Number>();
+            else
+                return yield_some<Number>(Number(--_current));
+        }
+
+        size_t next_batch(Number* buffer, size_t capacity)
+        {
+            size_t count = 0;
+            for (; count < capacity && _current != _start; ++count)
+                buffer[count] = --_current;
+            return count;
+        }
+
+        void skip(size_t count)
+        {
+            _current = details::integer_retreat(_current, std::min(count, details::integer_distance(_start, _current)));
+        }
+
+    private:
+
+        Number _start;
+        Number _current;
+    };
+
+
     // An enumerator based on a pair of STL-style iterators.
     // Implements:
     //
@@ -126,18 +550,41 @@ namespace forward
 
         auto next()
         {
-            using actual_type = decltype(*_current);
-            using stored_type = std::remove_reference<actual_type>::type;
+            using stored_type = std::decay_t<decltype(*_current)>;
 
             if (_current == _end)
             {
-                return yield_break<actual_type>();
+                return yield_none<stored_type>();
             }
             else
             {
-                auto&& result = *_current;
+                std::optional<stored_type> result(*_current);
                 ++_current;
-                return yield_return(std::forward<actual_type>(result));
+                return result;
+            }
+        }
+
+        template <typename T>
+        size_t next_batch(T* buffer, size_t capacity)
+        {
+            size_t count = 0;
+            for (; count < capacity && _current != _end; ++count, ++_current)
+                buffer[count] = *_current;
+            return count;
+        }
+
+        // Moves the iterator without copying the elements, in constant time for random access iterators
+        void skip(size_t count)
+        {
+            if constexpr (is_random_access<Iterator>)
+            {
+                _current += static_cast<typename std::iterator_traits<Iterator>::difference_type>(
+                    std::min(count, static_cast<size_t>(_end - _current)));
+            }
+            else
+            {
+                for (; count != 0 && _current != _end; --count)
+                    ++_current;
             }
         }
 
@@ -171,11 +618,46 @@ namespace forward
         auto next()
         {
             auto&& underlying = _enumerator.next();
-            using result_type = decltype(_transform(std::get<1>(underlying)));
+            using result_type = std::decay_t<decltype(_transform(get_value_by_ref(underlying)))>;
 
             return has_more(underlying)
-                ? yield_return(_transform(std::get<1>(underlying)))
-                : yield_break<result_type>();
+                ? yield_some(_transform(get_value_by_ref(underlying)))
+                : yield_none<result_type>();
+        }
+
+        // Transforms a whole batch of the underlying values at once
+        template <typename T>
+        size_t next_batch(T* buffer, size_t capacity)
+        {
+            using input_type = enumerated_type<Enumerator>;
+
+            if constexpr (is_batchable<input_type>)
+            {
+                std::array<input_type, batch_size> input;
+                size_t count = forward::next_batch(_enumerator, input.data(), std::min(capacity, batch_size));
+                for (size_t i = 0; i < count; ++i)
+                    buffer[i] = _transform(input[i]);
+                return count;
+            }
+            else
+            {
+                size_t count = 0;
+                for (; count < capacity; ++count)
+                {
+                    auto&& next = this->next();
+                    if (!has_more(next))
+                        break;
+                    buffer[count] = forward_value(next);
+                }
+                return count;
+            }
+        }
+
+        // Skipped elements are not transformed
+        template <typename E = Enumerator>
+        auto skip(size_t count) -> decltype(std::declval<E&>().skip(count))
+        {
+            return _enumerator.skip(count);
         }
 
     private:
@@ -212,17 +694,50 @@ namespace forward
 
         auto next()
         {
-            using actual_type = decltype(std::get<1>(_enumerator.next()));
-
+            // The underlying value is passed through, without being re-wrapped
             for (;;)
             {
-                auto&& current = _enumerator.next();
+                auto current = _enumerator.next();
 
                 if (!has_more(current))
-                    return yield_break<actual_type>();
+                    return current;
 
-                if (_filter(get_value_by_ref(current)))
-                    return yield_return(forward_value(current));
+                const auto& value = get_value_by_ref(current);
+                if (_filter(value))
+                    return current;
+            }
+        }
+
+        // Filters a whole batch of the underlying values at once: 
+        // the positions that pass the filter are first collected without branching into a selection vector, 
+        // and the buffer is then compacted.
+        template <typename T>
+        size_t next_batch(T* buffer, size_t capacity)
+        {
+            std::array<std::uint32_t, batch_size> selection;
+            capacity = std::min(capacity, batch_size);
+
+            for (;;)
+            {
+                size_t count = forward::next_batch(_enumerator, buffer, capacity);
+                if (count == 0)
+                    return 0;
+
+                size_t selected = 0;
+                for (size_t i = 0; i < count; ++i)
+                {
+                    selection[selected] = static_cast<std::uint32_t>(i);
+                    selected += _filter(std::as_const(buffer[i])) ? 1 : 0;
+                }
+
+                for (size_t i = 0; i < selected; ++i)
+                {
+                    if (selection[i] != i)
+                        buffer[i] = std::move(buffer[selection[i]]);
+                }
+
+                if (selected != 0)
+                    return selected;
             }
         }
 
@@ -232,31 +747,173 @@ namespace forward
         Filter _filter;
     };
 
-#pragma endregion
-
-#pragma region Enumerable
 
-    // Conceptually, enumerables are:
+    // Enumerators can optionally pass over elements without producing them:
     /*
 
-    struct Enumerable
-    {
-        static const bool is_enumerable = true;
-        using enumerator = AbstractEnumerator;
-
-        // Produce an enumerator over this content
-        enumerator get_enumerator() const;
-    };
+    // Passes over the next count elements, or over all the remaining ones if there are fewer
+    void skip(size_t count);
 
     */
+    // Enumerators over ranges and iterators implement it, in constant time for random access,
+    // and select forwards it to its underlying enumerator.
 
-    template <typename Number>
-    class RangeEnumerable
+    namespace details
     {
-    public:
+        template <typename Enumerator, typename = void>
+        struct has_skip : std::false_type {};
 
-        static const bool is_enumerable = true;
-        using enumerator = RangeEnumerator<Number>;
+        template <typename Enumerator>
+        struct has_skip<Enumerator, std::void_t<decltype(std::declval<Enumerator&>().skip(size_t()))>> : std::true_type {};
+
+        // Skips with the enumerator itself if it can, and otherwise by pulling the elements
+        template <typename Enumerator>
+        void skip_elements(Enumerator& enumerator, size_t count)
+        {
+            if constexpr (has_skip<Enumerator>::value)
+            {
+                enumerator.skip(count);
+            }
+            else
+            {
+                for (; count != 0; --count)
+                {
+                    auto&& next = enumerator.next();
+                    if (!has_more(next))
+                        return;
+                }
+            }
+        }
+    }
+
+
+    // An enumerator over the first elements of an underlying enumerator.
+    // Stops pulling from the underlying enumerator as soon as it has returned them.
+    template <typename Enumerator>
+    class TakeEnumerator
+    {
+    public:
+
+        static const bool is_enumerator = true;
+
+        TakeEnumerator(Enumerator enumerator, size_t count) :
+            _enumerator(std::move(enumerator)),
+            _remaining(count)
+        {
+        }
+
+        auto next() -> std::decay_t<decltype(std::declval<Enumerator&>().next())>
+        {
+            // A value-initialized nullable is the end, in both representations
+            if (_remaining == 0)
+                return {};
+
+            --_remaining;
+            return _enumerator.next();
+        }
+
+        template <typename T>
+        size_t next_batch(T* buffer, size_t capacity)
+        {
+            if (_remaining == 0)
+                return 0;
+
+            size_t count = forward::next_batch(_enumerator, buffer, std::min(capacity, _remaining));
+            _remaining -= count;
+            return count;
+        }
+
+        template <typename E = Enumerator>
+        auto skip(size_t count) -> decltype(std::declval<E&>().skip(count))
+        {
+            count = std::min(count, _remaining);
+            _remaining -= count;
+            return _enumerator.skip(count);
+        }
+
+    private:
+
+        Enumerator _enumerator;
+        size_t _remaining;
+    };
+
+
+    // An enumerator over an underlying enumerator, after its first elements.
+    // The elements are skipped on the first call, in constant time when the underlying enumerator allows it.
+    template <typename Enumerator>
+    class SkipEnumerator
+    {
+    public:
+
+        static const bool is_enumerator = true;
+
+        SkipEnumerator(Enumerator enumerator, size_t count) :
+            _enumerator(std::move(enumerator)),
+            _pending(count)
+        {
+        }
+
+        auto next()
+        {
+            skip_pending();
+            return _enumerator.next();
+        }
+
+        template <typename T>
+        size_t next_batch(T* buffer, size_t capacity)
+        {
+            skip_pending();
+            return forward::next_batch(_enumerator, buffer, capacity);
+        }
+
+        void skip(size_t count)
+        {
+            _pending += count;
+        }
+
+    private:
+
+        void skip_pending()
+        {
+            if (_pending != 0)
+            {
+                details::skip_elements(_enumerator, _pending);
+                _pending = 0;
+            }
+        }
+
+        Enumerator _enumerator;
+        size_t _pending;
+    };
+
+#pragma endregion
+
+#pragma region Enumerable
+
+    // Conceptually, enumerables are:
+    /*
+
+    struct Enumerable
+    {
+        static const bool is_enumerable = true;
+        using enumerator = AbstractEnumerator;
+
+        // Produce an enumerator over this content
+        enumerator get_enumerator() const;
+    };
+
+    */
+    // Stages own their upstream enumerable and their functions, so that a pipeline can be returned from a function
+    // or kept and enumerated again. Upstreams passed as rvalues are moved in, and those passed as lvalues are copied:
+    // views such as from(v) are cheap to copy, while from_moved copies its container.
+
+    template <typename Number>
+    class RangeEnumerable
+    {
+    public:
+
+        static const bool is_enumerable = true;
+        using enumerator = RangeEnumerator<Number>;
 
         RangeEnumerable(Number start, Number lastExcluded) :
             _current(start),
@@ -268,6 +925,51 @@ namespace forward
             return enumerator(_current, _lastExcluded);
         }
 
+        template <typename Sink>
+        void push_to(Sink& sink) const
+        {
+            for (Number i = _current; i != _lastExcluded; ++i)
+                sink(Number(i));
+        }
+
+        Number start() const
+        {
+            return _current;
+        }
+
+        Number last_excluded() const
+        {
+            return _lastExcluded;
+        }
+
+        template <typename N = Number, typename = std::enable_if_t<std::is_integral_v<N>>>
+        size_t source_size() const
+        {
+            return _current < _lastExcluded ? details::integer_distance(_current, _lastExcluded) : 0;
+        }
+
+        // Only for integers: the elements of a floating point range are not known from its end
+        template <typename N = Number, typename = std::enable_if_t<std::is_integral_v<N>>>
+        ReverseRangeEnumerator<Number> get_reverse_enumerator() const
+        {
+            return ReverseRangeEnumerator<Number>(_current, _lastExcluded);
+        }
+
+        std::optional<SizeHint> size_hint() const
+        {
+            if constexpr (std::is_integral_v<Number>)
+                return SizeHint{ source_size(), true };
+            else
+                return std::nullopt;
+        }
+
+        template <typename Sink>
+        void push_range(size_t first, size_t last, Sink& sink) const
+        {
+            for (Number i = _current + static_cast<Number>(first), end = _current + static_cast<Number>(last); i != end; ++i)
+                sink(Number(i));
+        }
+
     private:
 
         Number _current;
@@ -294,6 +996,47 @@ namespace forward
             return enumerator(_iteratable.begin(), _iteratable.end());
         }
 
+        template <typename I = iterator, typename = std::enable_if_t<is_bidirectional<I>>>
+        EnumeratorFromIterator<std::reverse_iterator<I>> get_reverse_enumerator() const
+        {
+            return EnumeratorFromIterator<std::reverse_iterator<I>>(
+                std::make_reverse_iterator(_iteratable.end()), std::make_reverse_iterator(_iteratable.begin()));
+        }
+
+        const Iteratable& iteratable() const
+        {
+            return _iteratable;
+        }
+
+        template <typename Sink>
+        void push_to(Sink& sink) const
+        {
+            for (const auto& value : _iteratable)
+                sink(value);
+        }
+
+        template <typename I = iterator, typename = std::enable_if_t<is_random_access<I>>>
+        size_t source_size() const
+        {
+            return static_cast<size_t>(_iteratable.end() - _iteratable.begin());
+        }
+
+        std::optional<SizeHint> size_hint() const
+        {
+            if constexpr (details::has_size<Iteratable>::value)
+                return SizeHint{ static_cast<size_t>(_iteratable.size()), true };
+            else
+                return std::nullopt;
+        }
+
+        template <typename Sink>
+        void push_range(size_t first, size_t last, Sink& sink) const
+        {
+            auto begin = _iteratable.begin();
+            for (auto it = begin + first, end = begin + last; it != end; ++it)
+                sink(*it);
+        }
+
     private:
 
         const Iteratable& _iteratable;
@@ -319,6 +1062,47 @@ namespace forward
             return enumerator(_iteratable.begin(), _iteratable.end());
         }
 
+        template <typename I = iterator, typename = std::enable_if_t<is_bidirectional<I>>>
+        EnumeratorFromIterator<std::reverse_iterator<I>> get_reverse_enumerator() const
+        {
+            return EnumeratorFromIterator<std::reverse_iterator<I>>(
+                std::make_reverse_iterator(_iteratable.end()), std::make_reverse_iterator(_iteratable.begin()));
+        }
+
+        const Iteratable& iteratable() const
+        {
+            return _iteratable;
+        }
+
+        template <typename Sink>
+        void push_to(Sink& sink) const
+        {
+            for (const auto& value : _iteratable)
+                sink(value);
+        }
+
+        template <typename I = iterator, typename = std::enable_if_t<is_random_access<I>>>
+        size_t source_size() const
+        {
+            return static_cast<size_t>(_iteratable.end() - _iteratable.begin());
+        }
+
+        std::optional<SizeHint> size_hint() const
+        {
+            if constexpr (details::has_size<Iteratable>::value)
+                return SizeHint{ static_cast<size_t>(_iteratable.size()), true };
+            else
+                return std::nullopt;
+        }
+
+        template <typename Sink>
+        void push_range(size_t first, size_t last, Sink& sink) const
+        {
+            auto begin = _iteratable.begin();
+            for (auto it = begin + first, end = begin + last; it != end; ++it)
+                sink(*it);
+        }
+
     private:
 
         Iteratable _iteratable;
@@ -333,8 +1117,8 @@ namespace forward
         static const bool is_enumerable = true;
         using enumerator = WhereEnumerator<typename Enumerable::enumerator, Filter>;
 
-        WhereEnumerable(const Enumerable& enumerable, const Filter& filter) :
-            _enumerable(enumerable),
+        WhereEnumerable(Enumerable enumerable, Filter filter) :
+            _enumerable(std::move(enumerable)),
             _filter(std::move(filter))
         {
         }
@@ -344,10 +1128,50 @@ namespace forward
             return enumerator(_enumerable.get_enumerator(), _filter);
         }
 
+        template <typename E = Enumerable>
+        auto get_reverse_enumerator() const -> WhereEnumerator<decltype(std::declval<const E&>().get_reverse_enumerator()), Filter>
+        {
+            return { _enumerable.get_reverse_enumerator(), _filter };
+        }
+
+        template <typename Sink>
+        void push_to(Sink& sink) const
+        {
+            for_each(_enumerable, filtered_sink(sink));
+        }
+
+        template <typename E = Enumerable>
+        auto source_size() const -> decltype(std::declval<const E&>().source_size())
+        {
+            return _enumerable.source_size();
+        }
+
+        std::optional<SizeHint> size_hint() const
+        {
+            return at_most(get_size_hint(_enumerable));
+        }
+
+        template <typename Sink>
+        void push_range(size_t first, size_t last, Sink& sink) const
+        {
+            auto filtered = filtered_sink(sink);
+            _enumerable.push_range(first, last, filtered);
+        }
+
     private:
 
-        const Enumerable& _enumerable;
-        const Filter& _filter;
+        template <typename Sink>
+        auto filtered_sink(Sink& sink) const
+        {
+            return [&sink, this](auto&& value)
+            {
+                if (_filter(std::as_const(value)))
+                    sink(std::forward<decltype(value)>(value));
+            };
+        }
+
+        Enumerable _enumerable;
+        Filter _filter;
     };
 
 
@@ -359,9 +1183,9 @@ namespace forward
         static const bool is_enumerable = true;
         using enumerator = SelectEnumerator<typename Enumerable::enumerator, Transform>;
 
-        SelectEnumerable(const Enumerable& enumerable, const Transform& filter) :
-            _enumerable(enumerable),
-            _transform(std::move(filter))
+        SelectEnumerable(Enumerable enumerable, Transform transform) :
+            _enumerable(std::move(enumerable)),
+            _transform(std::move(transform))
         {
         }
 
@@ -370,10 +1194,131 @@ namespace forward
             return enumerator(_enumerable.get_enumerator(), _transform);
         }
 
+        template <typename E = Enumerable>
+        auto get_reverse_enumerator() const -> SelectEnumerator<decltype(std::declval<const E&>().get_reverse_enumerator()), Transform>
+        {
+            return { _enumerable.get_reverse_enumerator(), _transform };
+        }
+
+        template <typename Sink>
+        void push_to(Sink& sink) const
+        {
+            for_each(_enumerable, transformed_sink(sink));
+        }
+
+        template <typename E = Enumerable>
+        auto source_size() const -> decltype(std::declval<const E&>().source_size())
+        {
+            return _enumerable.source_size();
+        }
+
+        std::optional<SizeHint> size_hint() const
+        {
+            return get_size_hint(_enumerable);
+        }
+
+        template <typename Sink>
+        void push_range(size_t first, size_t last, Sink& sink) const
+        {
+            auto transformed = transformed_sink(sink);
+            _enumerable.push_range(first, last, transformed);
+        }
+
+    private:
+
+        template <typename Sink>
+        auto transformed_sink(Sink& sink) const
+        {
+            return [&sink, this](auto&& value)
+            {
+                // Like the enumerator, pass the transform an lvalue. 
+                // Values that we do not own are copied if the transform wants to modify them.
+                using lvalue_type = decltype(value)&;
+                if constexpr (std::is_invocable_v<const Transform&, lvalue_type>)
+                {
+                    sink(_transform(value));
+                }
+                else
+                {
+                    std::decay_t<decltype(value)> copy(value);
+                    sink(_transform(copy));
+                }
+            };
+        }
+
+        Enumerable _enumerable;
+        Transform _transform;
+    };
+
+
+
+    template <typename Enumerable>
+    class TakeEnumerable
+    {
+    public:
+
+        static const bool is_enumerable = true;
+        using enumerator = TakeEnumerator<typename Enumerable::enumerator>;
+
+        TakeEnumerable(Enumerable enumerable, size_t count) :
+            _enumerable(std::move(enumerable)),
+            _count(count)
+        {
+        }
+
+        // No push_to: pulling is what lets the enumeration stop early
+        enumerator get_enumerator() const
+        {
+            return enumerator(_enumerable.get_enumerator(), _count);
+        }
+
+        std::optional<SizeHint> size_hint() const
+        {
+            // Only an existing hint is capped: the count alone says nothing about how many elements there are
+            auto hint = get_size_hint(_enumerable);
+            if (!hint)
+                return std::nullopt;
+            return SizeHint{ std::min(hint->size, _count), hint->is_exact };
+        }
+
+    private:
+
+        Enumerable _enumerable;
+        size_t _count;
+    };
+
+
+    template <typename Enumerable>
+    class SkipEnumerable
+    {
+    public:
+
+        static const bool is_enumerable = true;
+        using enumerator = SkipEnumerator<typename Enumerable::enumerator>;
+
+        SkipEnumerable(Enumerable enumerable, size_t count) :
+            _enumerable(std::move(enumerable)),
+            _count(count)
+        {
+        }
+
+        enumerator get_enumerator() const
+        {
+            return enumerator(_enumerable.get_enumerator(), _count);
+        }
+
+        std::optional<SizeHint> size_hint() const
+        {
+            auto hint = get_size_hint(_enumerable);
+            if (hint)
+                hint->size = hint->size > _count ? hint->size - _count : 0;
+            return hint;
+        }
+
     private:
 
-        const Enumerable& _enumerable;
-        const Transform& _transform;
+        Enumerable _enumerable;
+        size_t _count;
     };
 
 #pragma endregion
@@ -403,27 +1348,27 @@ namespace forward
     class WhereRightHandSide
     {
     private:
-        const Filter& _filter;
+        Filter _filter;
     public:
-        WhereRightHandSide(const Filter& filter) : _filter(filter) {}
+        WhereRightHandSide(Filter filter) : _filter(std::move(filter)) {}
 
         template <typename Enumerable>
-        WhereEnumerable<Enumerable, Filter> apply(const Enumerable& enumerable) const
+        WhereEnumerable<std::decay_t<Enumerable>, Filter> apply(Enumerable&& enumerable) &&
         {
-            return WhereEnumerable<Enumerable, Filter>(enumerable, _filter);
+            return WhereEnumerable<std::decay_t<Enumerable>, Filter>(std::forward<Enumerable>(enumerable), std::move(_filter));
         }
     };
 
     template <typename Filter>
-    WhereRightHandSide<Filter> where(const Filter& filter)
+    WhereRightHandSide<Filter> where(Filter filter)
     {
-        return WhereRightHandSide<Filter>(filter);
+        return WhereRightHandSide<Filter>(std::move(filter));
     }
 
     template <typename Enumerable, typename Filter>
-    WhereEnumerable<Enumerable, Filter> operator >> (const Enumerable& enumerable, const WhereRightHandSide<Filter>& whereRightHandSide)
+    WhereEnumerable<std::decay_t<Enumerable>, Filter> operator >> (Enumerable&& enumerable, WhereRightHandSide<Filter> whereRightHandSide)
     {
-        return whereRightHandSide.apply(enumerable);
+        return std::move(whereRightHandSide).apply(std::forward<Enumerable>(enumerable));
     }
 
 
@@ -432,56 +1377,557 @@ namespace forward
     class SelectRightHandSide
     {
     private:
-        const Transform& _map;
+        Transform _map;
     public:
-        SelectRightHandSide(const Transform& map) : _map(map) {}
+        SelectRightHandSide(Transform map) : _map(std::move(map)) {}
 
         template <typename Enumerable>
-        SelectEnumerable<Enumerable, Transform> apply(const Enumerable& enumerable) const
+        SelectEnumerable<std::decay_t<Enumerable>, Transform> apply(Enumerable&& enumerable) &&
         {
-            return SelectEnumerable<Enumerable, Transform>(enumerable, _map);
+            return SelectEnumerable<std::decay_t<Enumerable>, Transform>(std::forward<Enumerable>(enumerable), std::move(_map));
         }
     };
 
     template <typename Transform>
-    SelectRightHandSide<Transform> select(const Transform& map)
+    SelectRightHandSide<Transform> select(Transform map)
     {
-        return SelectRightHandSide<Transform>(map);
+        return SelectRightHandSide<Transform>(std::move(map));
     }
 
     template <typename Enumerable, typename Transform>
-    SelectEnumerable<Enumerable, Transform> operator >> (const Enumerable& enumerable, const SelectRightHandSide<Transform>& selectRightHandSide)
+    SelectEnumerable<std::decay_t<Enumerable>, Transform> operator >> (Enumerable&& enumerable, SelectRightHandSide<Transform> selectRightHandSide)
     {
-        return selectRightHandSide.apply(enumerable);
+        return std::move(selectRightHandSide).apply(std::forward<Enumerable>(enumerable));
     }
 
-#pragma endregion
-
-#pragma region Accumulator functions
 
-    template <typename Enumerable>
-    auto to_vector(const Enumerable& enumerable)
+    // Allow right hand side composition for take and skip
+    class TakeRightHandSide
     {
-        static_assert(Enumerable::is_enumerable, "Oops.");
-        auto enumerator = enumerable.get_enumerator();
-
-        using actual_type = decltype(std::get<1>(enumerator.next()));
-        using stored_type = std::remove_reference<actual_type>::type;
-
-        std::vector<stored_type> result;
+    private:
+        size_t _count;
+    public:
+        TakeRightHandSide(size_t count) : _count(count) {}
 
-        for (;;)
+        template <typename Enumerable>
+        TakeEnumerable<std::decay_t<Enumerable>> apply(Enumerable&& enumerable) const
         {
-            auto&& next = enumerator.next();
-            if (!has_more(next))
-                break;
-            result.push_back(std::forward<actual_type>(std::get<1>(next)));
+            return TakeEnumerable<std::decay_t<Enumerable>>(std::forward<Enumerable>(enumerable), _count);
         }
+    };
 
-        return result;
+    inline TakeRightHandSide take(size_t count)
+    {
+        return TakeRightHandSide(count);
     }
 
-    template <typename T>
+    template <typename Enumerable>
+    TakeEnumerable<std::decay_t<Enumerable>> operator >> (Enumerable&& enumerable, const TakeRightHandSide& takeRightHandSide)
+    {
+        return takeRightHandSide.apply(std::forward<Enumerable>(enumerable));
+    }
+
+
+    class SkipRightHandSide
+    {
+    private:
+        size_t _count;
+    public:
+        SkipRightHandSide(size_t count) : _count(count) {}
+
+        template <typename Enumerable>
+        SkipEnumerable<std::decay_t<Enumerable>> apply(Enumerable&& enumerable) const
+        {
+            return SkipEnumerable<std::decay_t<Enumerable>>(std::forward<Enumerable>(enumerable), _count);
+        }
+    };
+
+    inline SkipRightHandSide skip(size_t count)
+    {
+        return SkipRightHandSide(count);
+    }
+
+    template <typename Enumerable>
+    SkipEnumerable<std::decay_t<Enumerable>> operator >> (Enumerable&& enumerable, const SkipRightHandSide& skipRightHandSide)
+    {
+        return skipRightHandSide.apply(std::forward<Enumerable>(enumerable));
+    }
+
+#pragma endregion
+
+#pragma region Zip
+
+    namespace details
+    {
+        template <typename Enumerable, typename = void>
+        struct has_iteratable : std::false_type {};
+
+        template <typename Enumerable>
+        struct has_iteratable<Enumerable, std::void_t<decltype(
+            std::declval<const Enumerable&>().iteratable())>> : std::true_type {};
+
+        template <typename Enumerable, typename = void>
+        struct is_random_access_iteratable : std::false_type {};
+
+        template <typename Enumerable>
+        struct is_random_access_iteratable<Enumerable, std::void_t<decltype(
+            std::declval<const Enumerable&>().iteratable().begin())>> : std::bool_constant<
+                is_random_access<decltype(std::declval<const Enumerable&>().iteratable().begin())>> {};
+
+        // Walks the iterators of an iteratable, referring to its elements rather than copying them
+        template <typename Iterator>
+        class IteratorCursor
+        {
+        public:
+
+            using reference = decltype(*std::declval<const Iterator&>());
+            using element_type = std::conditional_t<std::is_reference_v<reference>,
+                const std::decay_t<reference>&, std::decay_t<reference>>;
+
+            IteratorCursor(Iterator current, Iterator end) :
+                _current(std::move(current)),
+                _end(std::move(end))
+            {}
+
+            bool at_end() const { return _current == _end; }
+            element_type get() { return *_current; }
+            void advance() { ++_current; }
+
+        private:
+
+            Iterator _current;
+            Iterator _end;
+        };
+
+        // Pulls from an enumerator, one element ahead
+        template <typename Enumerator>
+        class EnumeratorCursor
+        {
+        public:
+
+            using element_type = enumerated_type<Enumerator>;
+
+            EnumeratorCursor(Enumerator enumerator) :
+                _enumerator(std::move(enumerator))
+            {
+                advance();
+            }
+
+            bool at_end() const { return !has_more(*_current); }
+            element_type get() { return forward_value(*_current); }
+
+            // Emplaced rather than assigned, since tuples of references cannot be assigned
+            void advance() { _current.emplace(_enumerator.next()); }
+
+        private:
+
+            Enumerator _enumerator;
+            std::optional<std::decay_t<decltype(std::declval<Enumerator&>().next())>> _current;
+        };
+
+        template <typename Enumerable>
+        auto make_cursor(const Enumerable& enumerable)
+        {
+            if constexpr (has_iteratable<Enumerable>::value)
+            {
+                const auto& iteratable = enumerable.iteratable();
+                return IteratorCursor<decltype(iteratable.begin())>(iteratable.begin(), iteratable.end());
+            }
+            else
+            {
+                return EnumeratorCursor<decltype(enumerable.get_enumerator())>(enumerable.get_enumerator());
+            }
+        }
+
+        template <typename Enumerable>
+        auto make_cursor(const Enumerable& enumerable, size_t first, size_t last)
+        {
+            auto begin = enumerable.iteratable().begin();
+            return IteratorCursor<decltype(begin)>(begin + first, begin + last);
+        }
+
+        template <typename... Cursors>
+        bool any_at_end(const std::tuple<Cursors...>& cursors)
+        {
+            return std::apply([](const auto&... cursor) { return (cursor.at_end() || ...); }, cursors);
+        }
+
+        template <typename... Cursors>
+        auto get_all(std::tuple<Cursors...>& cursors)
+        {
+            return std::apply([](auto&... cursor)
+            {
+                return std::tuple<typename Cursors::element_type...>(cursor.get()...);
+            }, cursors);
+        }
+
+        template <typename... Cursors>
+        void advance_all(std::tuple<Cursors...>& cursors)
+        {
+            std::apply([](auto&... cursor) { (cursor.advance(), ...); }, cursors);
+        }
+    }
+
+    // An enumerator over several sources in lockstep, which ends with the shortest one.
+    // Yields tuples with a const reference to the elements of sources that are iteratables, 
+    // and the value of the elements of other sources. 
+    // Tuples holding references cannot be assigned, so loops over next() declare a new variable every time.
+    template <typename... Cursors>
+    class ZipEnumerator
+    {
+    public:
+
+        static const bool is_enumerator = true;
+        using value_type = std::tuple<typename Cursors::element_type...>;
+
+        ZipEnumerator(Cursors... cursors) :
+            _cursors(std::move(cursors)...)
+        {}
+
+        auto next()
+        {
+            if (details::any_at_end(_cursors))
+                return yield_none<value_type>();
+
+            std::optional<value_type> result(details::get_all(_cursors));
+            details::advance_all(_cursors);
+            return result;
+        }
+
+    private:
+
+        std::tuple<Cursors...> _cursors;
+    };
+
+    template <typename... Enumerables>
+    class ZipEnumerable
+    {
+    public:
+
+        static const bool is_enumerable = true;
+        using enumerator = ZipEnumerator<decltype(details::make_cursor(std::declval<const Enumerables&>()))...>;
+
+        ZipEnumerable(Enumerables... enumerables) :
+            _enumerables(std::move(enumerables)...)
+        {
+        }
+
+        enumerator get_enumerator() const
+        {
+            return std::apply([](const auto&... enumerable)
+            {
+                return enumerator(details::make_cursor(enumerable)...);
+            }, _enumerables);
+        }
+
+        // The same loop as next(), without wrapping the tuples
+        template <typename Sink>
+        void push_to(Sink& sink) const
+        {
+            auto cursors = std::apply([](const auto&... enumerable)
+            {
+                return std::make_tuple(details::make_cursor(enumerable)...);
+            }, _enumerables);
+
+            push_cursors(cursors, sink);
+        }
+
+        // Splittable when all the sources are iteratables with random access
+        template <bool B = (details::is_random_access_iteratable<Enumerables>::value && ...), typename = std::enable_if_t<B>>
+        size_t source_size() const
+        {
+            return std::apply([](const auto&... enumerable)
+            {
+                return std::min({ static_cast<size_t>(enumerable.iteratable().end() - enumerable.iteratable().begin())... });
+            }, _enumerables);
+        }
+
+        template <typename Sink>
+        void push_range(size_t first, size_t last, Sink& sink) const
+        {
+            auto cursors = std::apply([&](const auto&... enumerable)
+            {
+                return std::make_tuple(details::make_cursor(enumerable, first, last)...);
+            }, _enumerables);
+
+            push_cursors(cursors, sink);
+        }
+
+        // The smallest bound, exact if all the hints are
+        std::optional<SizeHint> size_hint() const
+        {
+            std::optional<SizeHint> result;
+            bool all_exact = true;
+
+            std::apply([&](const auto&... enumerable)
+            {
+                auto combine = [&](std::optional<SizeHint> hint)
+                {
+                    all_exact = all_exact && hint && hint->is_exact;
+                    if (hint && (!result || hint->size < result->size))
+                        result = hint;
+                };
+                (combine(get_size_hint(enumerable)), ...);
+            }, _enumerables);
+
+            if (result)
+                result->is_exact = all_exact;
+            return result;
+        }
+
+    private:
+
+        template <typename Cursors, typename Sink>
+        static void push_cursors(Cursors& cursors, Sink& sink)
+        {
+            for (; !details::any_at_end(cursors); details::advance_all(cursors))
+                sink(details::get_all(cursors));
+        }
+
+        std::tuple<Enumerables...> _enumerables;
+    };
+
+    // Enumerates several enumerables in lockstep, for instance:
+    //
+    // zip(from(a), from(b)) >> select([](const auto& t) { return std::get<0>(t) * std::get<1>(t); }) >> sum_from(0.0)
+    //
+    template <typename... Enumerables>
+    ZipEnumerable<std::decay_t<Enumerables>...> zip(Enumerables&&... enumerables)
+    {
+        static_assert((std::decay_t<Enumerables>::is_enumerable && ...), "Oops.");
+        return ZipEnumerable<std::decay_t<Enumerables>...>(std::forward<Enumerables>(enumerables)...);
+    }
+
+#pragma endregion
+
+#pragma region Select many
+
+    namespace details
+    {
+        template <typename T, typename = void>
+        struct is_enumerable_type : std::false_type {};
+
+        template <typename T>
+        struct is_enumerable_type<T, std::enable_if_t<T::is_enumerable>> : std::true_type {};
+
+        // What select_many enumerates for an element: enumerables as they are, containers returned by reference in place,
+        // and containers returned by value moved into an enumerable that owns them
+        template <typename Result>
+        auto selected_enumerable(Result&& result)
+        {
+            using result_type = std::decay_t<Result>;
+            if constexpr (is_enumerable_type<result_type>::value)
+                return result_type(std::forward<Result>(result));
+            else if constexpr (std::is_lvalue_reference_v<Result>)
+                return from(result);
+            else
+                return from_moved(std::move(result));
+        }
+    }
+
+    // An enumerator over the elements of the enumerables selected from every element of an underlying enumerator, 
+    // one after the other. The current element, the enumerable selected from it, and its enumerator are all held in place,
+    // so that nothing is allocated per element beyond what the selector itself returns.
+    template <typename Enumerator, typename Selector>
+    class SelectManyEnumerator
+    {
+    public:
+
+        static const bool is_enumerator = true;
+        using outer_type = enumerated_type<Enumerator>;
+        using inner_enumerable = decltype(details::selected_enumerable(std::declval<const Selector&>()(std::declval<const outer_type&>())));
+        using inner_enumerator = decltype(std::declval<const inner_enumerable&>().get_enumerator());
+
+        SelectManyEnumerator(Enumerator enumerator, Selector selector) :
+            _enumerator(std::move(enumerator)),
+            _selector(std::move(selector)),
+            _consumed(0)
+        {
+        }
+
+        // The inner enumerable may refer to the current element, and its enumerator to the inner enumerable:
+        // copies select them again from their own current element, and move past the elements already enumerated
+        SelectManyEnumerator(const SelectManyEnumerator& other) :
+            _enumerator(other._enumerator),
+            _selector(other._selector),
+            _current(other._current),
+            _consumed(other._consumed)
+        {
+            if (other._inner_enumerator)
+                reopen();
+        }
+
+        SelectManyEnumerator(SelectManyEnumerator&& other) :
+            _enumerator(std::move(other._enumerator)),
+            _selector(std::move(other._selector)),
+            _current(std::move(other._current)),
+            _consumed(other._consumed)
+        {
+            if (other._inner_enumerator)
+                reopen();
+        }
+
+        SelectManyEnumerator& operator = (const SelectManyEnumerator&) = delete;
+
+        auto next()
+        {
+            using nullable_type = std::decay_t<decltype(std::declval<inner_enumerator&>().next())>;
+
+            for (;;)
+            {
+                if (_inner_enumerator)
+                {
+                    auto current = _inner_enumerator->next();
+                    if (has_more(current))
+                    {
+                        ++_consumed;
+                        return current;
+                    }
+
+                    _inner_enumerator.reset();
+                    _inner.reset();
+                }
+
+                auto current = _enumerator.next();
+                if (!has_more(current))
+                    return nullable_type();
+
+                _current.emplace(forward_value(current));
+                _consumed = 0;
+                open();
+            }
+        }
+
+    private:
+
+        void open()
+        {
+            _inner.emplace(details::selected_enumerable(_selector(std::as_const(*_current))));
+            _inner_enumerator.emplace(_inner->get_enumerator());
+        }
+
+        void reopen()
+        {
+            open();
+            details::skip_elements(*_inner_enumerator, _consumed);
+        }
+
+        Enumerator _enumerator;
+        Selector _selector;
+        std::optional<outer_type> _current;
+        std::optional<inner_enumerable> _inner;
+        std::optional<inner_enumerator> _inner_enumerator;
+        size_t _consumed;
+    };
+
+    // The elements of the enumerables or containers selected from every element, flattened in order, for instance:
+    //
+    // from(orders) >> select_many([](const Order& o) -> const std::vector<Item>& { return o.items; })
+    //
+    // Containers returned by reference are enumerated in place, and must live in the element or outlive the enumeration.
+    template <typename Enumerable, typename Selector>
+    class SelectManyEnumerable
+    {
+    public:
+
+        static const bool is_enumerable = true;
+        using enumerator = SelectManyEnumerator<typename Enumerable::enumerator, Selector>;
+
+        SelectManyEnumerable(Enumerable enumerable, Selector selector) :
+            _enumerable(std::move(enumerable)),
+            _selector(std::move(selector))
+        {
+        }
+
+        enumerator get_enumerator() const
+        {
+            return enumerator(_enumerable.get_enumerator(), _selector);
+        }
+
+        template <typename Sink>
+        void push_to(Sink& sink) const
+        {
+            for_each(_enumerable, flattened_sink(sink));
+        }
+
+        // Parallel enumerations split the underlying elements, whatever the number of elements selected from each of them
+        template <typename E = Enumerable>
+        auto source_size() const -> decltype(std::declval<const E&>().source_size())
+        {
+            return _enumerable.source_size();
+        }
+
+        template <typename Sink>
+        void push_range(size_t first, size_t last, Sink& sink) const
+        {
+            auto flattened = flattened_sink(sink);
+            _enumerable.push_range(first, last, flattened);
+        }
+
+    private:
+
+        template <typename Sink>
+        auto flattened_sink(Sink& sink) const
+        {
+            return [&sink, this](auto&& value)
+            {
+                for_each(details::selected_enumerable(_selector(std::as_const(value))), sink);
+            };
+        }
+
+        Enumerable _enumerable;
+        Selector _selector;
+    };
+
+    template <typename Selector>
+    class SelectManyRightHandSide
+    {
+    private:
+        Selector _selector;
+    public:
+        SelectManyRightHandSide(Selector selector) : _selector(std::move(selector)) {}
+
+        template <typename Enumerable>
+        SelectManyEnumerable<std::decay_t<Enumerable>, Selector> apply(Enumerable&& enumerable) &&
+        {
+            return SelectManyEnumerable<std::decay_t<Enumerable>, Selector>(std::forward<Enumerable>(enumerable), std::move(_selector));
+        }
+    };
+
+    template <typename Selector>
+    SelectManyRightHandSide<Selector> select_many(Selector selector)
+    {
+        return SelectManyRightHandSide<Selector>(std::move(selector));
+    }
+
+    template <typename Enumerable, typename Selector>
+    SelectManyEnumerable<std::decay_t<Enumerable>, Selector> operator >> (Enumerable&& enumerable, SelectManyRightHandSide<Selector> selectManyRightHandSide)
+    {
+        return std::move(selectManyRightHandSide).apply(std::forward<Enumerable>(enumerable));
+    }
+
+#pragma endregion
+
+#pragma region Accumulator functions
+
+    template <typename Enumerable>
+    auto to_vector(const Enumerable& enumerable)
+    {
+        static_assert(Enumerable::is_enumerable, "Oops.");
+        using stored_type = enumerated_type<decltype(enumerable.get_enumerator())>;
+
+        std::vector<stored_type> result;
+        result.reserve(reserved_size(get_size_hint(enumerable)));
+
+        for_each(enumerable, [&](auto&& value)
+        {
+            result.push_back(std::forward<decltype(value)>(value));
+        });
+
+        return result;
+    }
+
+    template <typename T>
     class ToVector
     {
     public:
@@ -507,18 +1953,95 @@ namespace forward
     }
 
 
+    namespace details
+    {
+        // Adds the elements one after the other, in the order of the enumeration
+        template <typename Enumerable, typename T>
+        T sum_by_element(const Enumerable& enumerable, T zero)
+        {
+            T result = std::move(zero);
+
+            for_each(enumerable, [&](const auto& value)
+            {
+                result = result + value;
+            });
+
+            return result;
+        }
+
+        template <typename Enumerable, typename T>
+        struct is_integral_range : std::false_type {};
+
+        template <typename Number, typename T>
+        struct is_integral_range<RangeEnumerable<Number>, T> : std::bool_constant<
+            std::is_integral_v<Number> && !std::is_same_v<Number, bool> &&
+            std::is_integral_v<T> && !std::is_same_v<T, bool>> {};
+
+        // The sum of a range of integers in closed form, computed modulo 2^bits. 
+        // This wraps around exactly like adding the elements one after the other.
+        template <typename Number, typename T>
+        T sum_range(const RangeEnumerable<Number>& range, T zero)
+        {
+            using U = std::make_unsigned_t<std::common_type_t<T, Number, unsigned int>>;
+
+            U start = static_cast<U>(range.start());
+            U count = range.start() < range.last_excluded() ? static_cast<U>(range.last_excluded()) - start : 0;
+            U triangle = count % 2 == 0 ? (count / 2) * (count - 1) : count * ((count - 1) / 2);
+
+            return static_cast<T>(static_cast<U>(zero) + count * start + triangle);
+        }
+
+        template <typename Enumerable, typename = void>
+        struct is_contiguous : std::false_type {};
+
+        template <typename Enumerable>
+        struct is_contiguous<Enumerable, std::void_t<decltype(
+            std::declval<const Enumerable&>().iteratable().data())>> : std::true_type {};
+    }
+
+    // Ranges of integers are summed in closed form.
+    // Arithmetic values of the type of zero are summed by the vectorized kernels of sum_array directly over the array 
+    // of contiguous sources. Other pipelines are pushed when they can be, which inlines into a single loop, 
+    // and pull-only ones, such as those ending with take or skip, are summed over the batches of their enumerator.
+    // Floating point values may then be rounded differently than when added one after the other.
     template <typename Enumerable, typename T>
     auto sum_from(const Enumerable& enumerable, T zero)
     {
         static_assert(Enumerable::is_enumerable, "Oops.");
-        T result = std::move(zero);
+        using enumerator_type = decltype(enumerable.get_enumerator());
+        using value_type = enumerated_type<enumerator_type>;
 
-        for (auto enumerator = enumerable.get_enumerator();;)
+        if constexpr (details::is_integral_range<Enumerable, T>::value)
         {
-            auto&& next = enumerator.next();
-            if (!has_more(next))
-                return result;
-            result = result + get_value_by_ref(next);
+            return details::sum_range(enumerable, zero);
+        }
+        else if constexpr (!has_sum_kernel<T> || !std::is_same_v<value_type, T>)
+        {
+            return details::sum_by_element(enumerable, std::move(zero));
+        }
+        else if constexpr (details::is_contiguous<Enumerable>::value)
+        {
+            const auto& iteratable = enumerable.iteratable();
+            return static_cast<T>(zero + sum_array(iteratable.data(), iteratable.size()));
+        }
+        else if constexpr (details::has_push_to<Enumerable>::value)
+        {
+            return details::sum_by_element(enumerable, std::move(zero));
+        }
+        else if constexpr (details::has_next_batch<enumerator_type>::value)
+        {
+            std::array<T, batch_size> buffer;
+            T result = zero;
+
+            auto enumerator = enumerable.get_enumerator();
+            for (size_t count; (count = enumerator.next_batch(buffer.data(), batch_size)) != 0;)
+                result = static_cast<T>(result + sum_array(buffer.data(), count));
+
+            return result;
+        }
+        else
+        {
+            return details::sum_by_element(enumerable, std::move(zero));
         }
     }
 
@@ -554,5 +2077,368 @@ namespace forward
         return SumFrom<T>(std::move(zero));
     }
 
+
+    template <typename Action>
+    class ForEach
+    {
+    public:
+
+        ForEach(Action action) :
+            _action(std::move(action))
+        {}
+
+        template <typename Enumerable>
+        void apply(const Enumerable& enumerable) const
+        {
+            for_each(enumerable, _action);
+        }
+
+    private:
+
+        Action _action;
+    };
+
+    template <typename Enumerable, typename Action>
+    void operator >> (const Enumerable& enumerable, const ForEach<Action>& fold)
+    {
+        fold.apply(enumerable);
+    }
+
+    template <typename Action>
+    ForEach<Action> for_each(Action action)
+    {
+        return ForEach<Action>(std::move(action));
+    }
+
+
+    // The first element, or nothing if there is none. Pulls a single element.
+    template <typename Enumerable>
+    auto first(const Enumerable& enumerable)
+    {
+        static_assert(Enumerable::is_enumerable, "Oops.");
+        using stored_type = enumerated_type<decltype(enumerable.get_enumerator())>;
+
+        auto enumerator = enumerable.get_enumerator();
+        auto&& next = enumerator.next();
+        return has_more(next) ? std::optional<stored_type>(forward_value(next)) : std::nullopt;
+    }
+
+    template <typename T>
+    class First
+    {
+    public:
+
+        template <typename Enumerable>
+        std::optional<T> apply(const Enumerable& enumerable) const
+        {
+            return first(enumerable);
+        }
+    };
+
+    template <typename Enumerable, typename T>
+    std::optional<T> operator >> (const Enumerable& enumerable, const First<T>& fold)
+    {
+        return fold.apply(enumerable);
+    }
+
+    template <typename T>
+    First<T> first()
+    {
+        return First<T>();
+    }
+
+
+    // The only element, or nothing if there is none or more than one. Pulls at most two elements.
+    template <typename Enumerable>
+    auto single(const Enumerable& enumerable)
+    {
+        static_assert(Enumerable::is_enumerable, "Oops.");
+        using stored_type = enumerated_type<decltype(enumerable.get_enumerator())>;
+
+        auto enumerator = enumerable.get_enumerator();
+        auto&& next = enumerator.next();
+        if (!has_more(next))
+            return std::optional<stored_type>();
+
+        std::optional<stored_type> result(forward_value(next));
+        if (has_more(enumerator.next()))
+            return std::optional<stored_type>();
+        return result;
+    }
+
+    template <typename T>
+    class Single
+    {
+    public:
+
+        template <typename Enumerable>
+        std::optional<T> apply(const Enumerable& enumerable) const
+        {
+            return single(enumerable);
+        }
+    };
+
+    template <typename Enumerable, typename T>
+    std::optional<T> operator >> (const Enumerable& enumerable, const Single<T>& fold)
+    {
+        return fold.apply(enumerable);
+    }
+
+    template <typename T>
+    Single<T> single()
+    {
+        return Single<T>();
+    }
+
+
+    // The number of elements, without enumerating them when the size hint is exact
+    template <typename Enumerable>
+    size_t count(const Enumerable& enumerable)
+    {
+        static_assert(Enumerable::is_enumerable, "Oops.");
+
+        auto hint = get_size_hint(enumerable);
+        if (hint && hint->is_exact)
+            return hint->size;
+
+        size_t result = 0;
+        for_each(enumerable, [&](const auto&) { ++result; });
+        return result;
+    }
+
+    class Count
+    {
+    public:
+
+        template <typename Enumerable>
+        size_t apply(const Enumerable& enumerable) const
+        {
+            return count(enumerable);
+        }
+    };
+
+    template <typename Enumerable>
+    size_t operator >> (const Enumerable& enumerable, const Count& fold)
+    {
+        return fold.apply(enumerable);
+    }
+
+    inline Count count()
+    {
+        return Count();
+    }
+
+
+    // Whether there is no element, from the size hint if it tells, and otherwise by pulling at most one element
+    template <typename Enumerable>
+    bool is_empty(const Enumerable& enumerable)
+    {
+        static_assert(Enumerable::is_enumerable, "Oops.");
+
+        auto hint = get_size_hint(enumerable);
+        if (hint && (hint->is_exact || hint->size == 0))
+            return hint->size == 0;
+
+        auto enumerator = enumerable.get_enumerator();
+        return !has_more(enumerator.next());
+    }
+
+    class IsEmpty
+    {
+    public:
+
+        template <typename Enumerable>
+        bool apply(const Enumerable& enumerable) const
+        {
+            return is_empty(enumerable);
+        }
+    };
+
+    template <typename Enumerable>
+    bool operator >> (const Enumerable& enumerable, const IsEmpty& fold)
+    {
+        return fold.apply(enumerable);
+    }
+
+    inline IsEmpty is_empty()
+    {
+        return IsEmpty();
+    }
+
+
+    // Whether some element passes the predicate. Stops pulling at the first one that does.
+    template <typename Enumerable, typename Predicate>
+    bool exists(const Enumerable& enumerable, const Predicate& predicate)
+    {
+        static_assert(Enumerable::is_enumerable, "Oops.");
+
+        auto enumerator = enumerable.get_enumerator();
+        for (;;)
+        {
+            auto&& next = enumerator.next();
+            if (!has_more(next))
+                return false;
+            if (predicate(std::as_const(get_value_by_ref(next))))
+                return true;
+        }
+    }
+
+    template <typename Predicate>
+    class Exists
+    {
+    public:
+
+        Exists(Predicate predicate) :
+            _predicate(std::move(predicate))
+        {}
+
+        template <typename Enumerable>
+        bool apply(const Enumerable& enumerable) const
+        {
+            return exists(enumerable, _predicate);
+        }
+
+    private:
+
+        Predicate _predicate;
+    };
+
+    template <typename Enumerable, typename Predicate>
+    bool operator >> (const Enumerable& enumerable, const Exists<Predicate>& fold)
+    {
+        return fold.apply(enumerable);
+    }
+
+    template <typename Predicate>
+    Exists<Predicate> exists(Predicate predicate)
+    {
+        return Exists<Predicate>(std::move(predicate));
+    }
+
+
+    // Whether all the elements pass the predicate. Stops pulling at the first one that does not.
+    template <typename Enumerable, typename Predicate>
+    bool forall(const Enumerable& enumerable, const Predicate& predicate)
+    {
+        return !exists(enumerable, [&](const auto& value) { return !predicate(value); });
+    }
+
+    template <typename Predicate>
+    class Forall
+    {
+    public:
+
+        Forall(Predicate predicate) :
+            _predicate(std::move(predicate))
+        {}
+
+        template <typename Enumerable>
+        bool apply(const Enumerable& enumerable) const
+        {
+            return forall(enumerable, _predicate);
+        }
+
+    private:
+
+        Predicate _predicate;
+    };
+
+    template <typename Enumerable, typename Predicate>
+    bool operator >> (const Enumerable& enumerable, const Forall<Predicate>& fold)
+    {
+        return fold.apply(enumerable);
+    }
+
+    template <typename Predicate>
+    Forall<Predicate> forall(Predicate predicate)
+    {
+        return Forall<Predicate>(std::move(predicate));
+    }
+
+
+    namespace details
+    {
+        template <size_t Index>
+        struct Get
+        {
+            template <typename Tuple>
+            decltype(auto) operator () (const Tuple& tuple) const
+            {
+                return std::get<Index>(tuple);
+            }
+        };
+
+        template <typename Enumerable, typename... Projections>
+        auto unzip_by(const Enumerable& enumerable, const Projections&... projections)
+        {
+            static_assert(Enumerable::is_enumerable, "Oops.");
+            using stored_type = enumerated_type<decltype(enumerable.get_enumerator())>;
+
+            std::tuple<std::vector<std::decay_t<decltype(projections(std::declval<const stored_type&>()))>>...> result;
+            size_t reserved = reserved_size(get_size_hint(enumerable));
+            std::apply([&](auto&... vector) { (vector.reserve(reserved), ...); }, result);
+
+            for_each(enumerable, [&](const auto& value)
+            {
+                std::apply([&](auto&... vector) { (vector.push_back(projections(value)), ...); }, result);
+            });
+
+            return result;
+        }
+
+        template <typename Enumerable, size_t... Indices>
+        auto unzip_tuples(const Enumerable& enumerable, std::index_sequence<Indices...>)
+        {
+            return unzip_by(enumerable, Get<Indices>()...);
+        }
+    }
+
+    // Writes every projection of the elements into its own vector, in a single pass, 
+    // and returns the tuple of the vectors. Without projections, the elements must be tuples or pairs,
+    // and every one of their components goes to its own vector.
+    template <typename... Projections>
+    class Unzip
+    {
+    public:
+
+        Unzip(Projections... projections) :
+            _projections(std::move(projections)...)
+        {}
+
+        template <typename Enumerable>
+        auto apply(const Enumerable& enumerable) const
+        {
+            using stored_type = enumerated_type<decltype(enumerable.get_enumerator())>;
+
+            if constexpr (sizeof...(Projections) == 0)
+            {
+                return details::unzip_tuples(enumerable, std::make_index_sequence<std::tuple_size_v<stored_type>>());
+            }
+            else
+            {
+                return std::apply([&](const auto&... projections)
+                {
+                    return details::unzip_by(enumerable, projections...);
+                }, _projections);
+            }
+        }
+
+    private:
+
+        std::tuple<Projections...> _projections;
+    };
+
+    template <typename Enumerable, typename... Projections>
+    auto operator >> (const Enumerable& enumerable, const Unzip<Projections...>& fold)
+    {
+        return fold.apply(enumerable);
+    }
+
+    template <typename... Projections>
+    Unzip<Projections...> unzip(Projections... projections)
+    {
+        return Unzip<Projections...>(std::move(projections)...);
+    }
+
 #pragma endregion
 }
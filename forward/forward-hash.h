@@ -0,0 +1,740 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "forward-simd.h"
+
+namespace forward
+{
+    // CONTAINS:
+    // FlatHashSet, FlatHashMap
+    //
+    // Open addressing hash tables, storing their elements in a single array next to an array of control bytes.
+    // Every control byte tells whether its slot is empty, deleted, or full, and then holds 7 bits of the hash
+    // of the element. Lookups compare 16 control bytes at once, and only compare the elements whose bits match.
+
+#pragma region Flat table
+
+    namespace details
+    {
+        // Spreads the bits of hashes such as std::hash<int>, which is the identity with most libraries,
+        // so that both the position and the control bits of the elements are well distributed.
+        inline size_t mix_hash(size_t hash)
+        {
+            std::uint64_t mixed = static_cast<std::uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+            return static_cast<size_t>(mixed ^ (mixed >> 32));
+        }
+
+        using control_byte = std::int8_t;
+
+        const control_byte control_empty = -128;   // 0b10000000
+        const control_byte control_deleted = -2;   // 0b11111110
+        const size_t group_width = 16;
+
+        // The slots of a group of 16 control bytes that match a condition, one bit per slot
+        class GroupMask
+        {
+        public:
+
+            explicit GroupMask(std::uint32_t bits) :
+                _bits(bits)
+            {}
+
+            explicit operator bool() const
+            {
+                return _bits != 0;
+            }
+
+            size_t lowest() const
+            {
+#if defined(_MSC_VER)
+                unsigned long index;
+                _BitScanForward(&index, _bits);
+                return index;
+#else
+                return static_cast<size_t>(__builtin_ctz(_bits));
+#endif
+            }
+
+            void remove_lowest()
+            {
+                _bits &= _bits - 1;
+            }
+
+        private:
+
+            std::uint32_t _bits;
+        };
+
+        class Group
+        {
+        public:
+
+            explicit Group(const control_byte* controls)
+            {
+#ifdef FORWARD_X64
+                _controls = _mm_loadu_si128(reinterpret_cast<const __m128i*>(controls));
+#else
+                for (size_t i = 0; i < group_width; ++i)
+                    _controls[i] = controls[i];
+#endif
+            }
+
+            GroupMask match(control_byte hash_bits) const
+            {
+#ifdef FORWARD_X64
+                return GroupMask(static_cast<std::uint32_t>(
+                    _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(hash_bits), _controls))));
+#else
+                std::uint32_t bits = 0;
+                for (size_t i = 0; i < group_width; ++i)
+                    bits |= std::uint32_t(_controls[i] == hash_bits) << i;
+                return GroupMask(bits);
+#endif
+            }
+
+            GroupMask match_empty() const
+            {
+                return match(control_empty);
+            }
+
+            // Empty or deleted slots, whose control bytes have their sign bit set
+            GroupMask match_free() const
+            {
+#ifdef FORWARD_X64
+                return GroupMask(static_cast<std::uint32_t>(_mm_movemask_epi8(_controls)));
+#else
+                std::uint32_t bits = 0;
+                for (size_t i = 0; i < group_width; ++i)
+                    bits |= std::uint32_t(_controls[i] < 0) << i;
+                return GroupMask(bits);
+#endif
+            }
+
+        private:
+
+#ifdef FORWARD_X64
+            __m128i _controls;
+#else
+            control_byte _controls[group_width];
+#endif
+        };
+
+        // The table behind the flat hash containers. Slots hold the elements, and KeyOf gives the key of a slot.
+        // The capacity is a power of two, and at most 7/8 of the slots are full or deleted.
+        // Groups are probed quadratically from the position given by the high bits of the hash.
+        // The first group_width - 1 control bytes are repeated after the last one,
+        // so that a group can be loaded from any position.
+        template <typename Slot, typename KeyOf, typename Hash, typename Equal>
+        class FlatTable
+        {
+        public:
+
+            template <bool IsConst>
+            class basic_iterator
+            {
+            public:
+
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = Slot;
+                using difference_type = std::ptrdiff_t;
+                using pointer = std::conditional_t<IsConst, const Slot*, Slot*>;
+                using reference = std::conditional_t<IsConst, const Slot&, Slot&>;
+
+                basic_iterator() :
+                    _controls(nullptr),
+                    _slots(nullptr),
+                    _index(0),
+                    _capacity(0)
+                {}
+
+                basic_iterator(const control_byte* controls, Slot* slots, size_t index, size_t capacity) :
+                    _controls(controls),
+                    _slots(slots),
+                    _index(index),
+                    _capacity(capacity)
+                {
+                    skip_free();
+                }
+
+                // From iterator to const_iterator
+                template <bool OtherIsConst, typename = std::enable_if_t<IsConst && !OtherIsConst>>
+                basic_iterator(const basic_iterator<OtherIsConst>& other) :
+                    _controls(other._controls),
+                    _slots(other._slots),
+                    _index(other._index),
+                    _capacity(other._capacity)
+                {}
+
+                reference operator * () const
+                {
+                    return _slots[_index];
+                }
+
+                pointer operator -> () const
+                {
+                    return _slots + _index;
+                }
+
+                basic_iterator& operator ++ ()
+                {
+                    ++_index;
+                    skip_free();
+                    return *this;
+                }
+
+                basic_iterator operator ++ (int)
+                {
+                    auto copy = *this;
+                    ++*this;
+                    return copy;
+                }
+
+                bool operator == (const basic_iterator& other) const
+                {
+                    return _index == other._index;
+                }
+
+                bool operator != (const basic_iterator& other) const
+                {
+                    return _index != other._index;
+                }
+
+            private:
+
+                template <bool> friend class basic_iterator;
+
+                void skip_free()
+                {
+                    while (_index < _capacity && _controls[_index] < 0)
+                        ++_index;
+                }
+
+                const control_byte* _controls;
+                Slot* _slots;
+                size_t _index;
+                size_t _capacity;
+            };
+
+            using iterator = basic_iterator<false>;
+            using const_iterator = basic_iterator<true>;
+
+            FlatTable(const Hash& hash = Hash(), const Equal& equal = Equal()) :
+                _capacity(0),
+                _size(0),
+                _deleted(0),
+                _slots(nullptr),
+                _hash(hash),
+                _equal(equal)
+            {}
+
+            FlatTable(const FlatTable& other) :
+                FlatTable(other._hash, other._equal)
+            {
+                reserve(other._size);
+                for (const auto& slot : other)
+                    insert_unique(slot);
+            }
+
+            FlatTable(FlatTable&& other) noexcept :
+                FlatTable(other._hash, other._equal)
+            {
+                swap(other);
+            }
+
+            FlatTable& operator = (FlatTable other) noexcept
+            {
+                swap(other);
+                return *this;
+            }
+
+            ~FlatTable()
+            {
+                destroy();
+            }
+
+            void swap(FlatTable& other) noexcept
+            {
+                std::swap(_capacity, other._capacity);
+                std::swap(_size, other._size);
+                std::swap(_deleted, other._deleted);
+                std::swap(_controls, other._controls);
+                std::swap(_slots, other._slots);
+                std::swap(_hash, other._hash);
+                std::swap(_equal, other._equal);
+            }
+
+            size_t size() const
+            {
+                return _size;
+            }
+
+            size_t capacity() const
+            {
+                return _capacity;
+            }
+
+            iterator begin()
+            {
+                return iterator(_controls.get(), _slots, 0, _capacity);
+            }
+
+            iterator end()
+            {
+                return iterator(_controls.get(), _slots, _capacity, _capacity);
+            }
+
+            const_iterator begin() const
+            {
+                return const_iterator(_controls.get(), _slots, 0, _capacity);
+            }
+
+            const_iterator end() const
+            {
+                return const_iterator(_controls.get(), _slots, _capacity, _capacity);
+            }
+
+            // Makes room for count elements without growing again
+            void reserve(size_t count)
+            {
+                if (count == 0)
+                    return;
+
+                size_t capacity = group_width;
+                while (capacity - capacity / 8 < count)
+                    capacity *= 2;
+
+                if (capacity > _capacity)
+                    rehash(capacity);
+            }
+
+            template <typename Key>
+            iterator find(const Key& key)
+            {
+                if (_size == 0)
+                    return end();
+
+                size_t hash = mix_hash(_hash(key));
+                auto bits = hash_bits(hash);
+                size_t mask = _capacity - 1;
+
+                for (size_t position = hash >> 7 & mask, step = 0;; position = (position + (step += group_width)) & mask)
+                {
+                    Group group(_controls.get() + position);
+                    for (auto matches = group.match(bits); matches; matches.remove_lowest())
+                    {
+                        size_t index = (position + matches.lowest()) & mask;
+                        if (_equal(KeyOf()(_slots[index]), key))
+                            return iterator(_controls.get(), _slots, index, _capacity);
+                    }
+
+                    if (group.match_empty())
+                        return end();
+                }
+            }
+
+            template <typename Key>
+            const_iterator find(const Key& key) const
+            {
+                return const_cast<FlatTable*>(this)->find(key);
+            }
+
+            // Looks for the key, and when it is missing calls construct(memory) to build a slot with that key in place.
+            // Returns the slot, and whether it was constructed.
+            template <typename Key, typename Construct>
+            std::pair<iterator, bool> find_or_construct(const Key& key, Construct&& construct)
+            {
+                size_t hash = mix_hash(_hash(key));
+
+                if (_size != 0)
+                {
+                    // Scoped to the lookup: when the control byte stays alive until the insertion below, 
+                    // GCC spills it and reloads it wider at every lookup, which defeats store forwarding
+                    auto bits = hash_bits(hash);
+                    size_t mask = _capacity - 1;
+                    for (size_t position = hash >> 7 & mask, step = 0;; position = (position + (step += group_width)) & mask)
+                    {
+                        Group group(_controls.get() + position);
+                        for (auto matches = group.match(bits); matches; matches.remove_lowest())
+                        {
+                            size_t index = (position + matches.lowest()) & mask;
+                            if (_equal(KeyOf()(_slots[index]), key))
+                                return { iterator(_controls.get(), _slots, index, _capacity), false };
+                        }
+
+                        if (group.match_empty())
+                            break;
+                    }
+                }
+
+                if (_size + _deleted + 1 > _capacity - _capacity / 8)
+                    grow();
+
+                size_t index = free_slot(hash);
+                construct(static_cast<void*>(_slots + index));
+                _deleted -= _controls[index] == control_deleted;
+                set_control(index, hash_bits(hash));
+                ++_size;
+
+                return { iterator(_controls.get(), _slots, index, _capacity), true };
+            }
+
+            template <typename Key>
+            size_t erase(const Key& key)
+            {
+                auto found = find(key);
+                if (found == end())
+                    return 0;
+
+                size_t index = static_cast<size_t>(&*found - _slots);
+                _slots[index].~Slot();
+                set_control(index, control_deleted);
+                --_size;
+                ++_deleted;
+                return 1;
+            }
+
+            // Moves the elements of other whose keys are missing, and empties other
+            template <typename Other>
+            void merge(Other&& other)
+            {
+                for (auto& slot : other)
+                {
+                    find_or_construct(KeyOf()(slot), [&](void* memory)
+                    {
+                        new (memory) Slot(std::move(slot));
+                    });
+                }
+                other.clear();
+            }
+
+            // Destroys the elements, and keeps the capacity for the next ones
+            void clear()
+            {
+                if (_slots == nullptr)
+                    return;
+
+                for (auto& slot : *this)
+                    slot.~Slot();
+                std::fill(_controls.get(), _controls.get() + _capacity + group_width - 1, control_empty);
+                _size = 0;
+                _deleted = 0;
+            }
+
+        private:
+
+            static control_byte hash_bits(size_t hash)
+            {
+                return static_cast<control_byte>(hash & 0x7f);
+            }
+
+            // The first empty or deleted slot on the probing sequence of a hash
+            size_t free_slot(size_t hash) const
+            {
+                size_t mask = _capacity - 1;
+                for (size_t position = hash >> 7 & mask, step = 0;; position = (position + (step += group_width)) & mask)
+                {
+                    if (auto free = Group(_controls.get() + position).match_free())
+                        return (position + free.lowest()) & mask;
+                }
+            }
+
+            void set_control(size_t index, control_byte control)
+            {
+                _controls[index] = control;
+                if (index < group_width - 1)
+                    _controls[_capacity + index] = control;
+            }
+
+            // Doubles the capacity, unless enough of the slots are deleted to make room by cleaning them up
+            void grow()
+            {
+                if (_capacity == 0)
+                    rehash(group_width);
+                else if (_deleted > _capacity / 4)
+                    rehash(_capacity);
+                else
+                    rehash(_capacity * 2);
+            }
+
+            template <typename Value>
+            void insert_unique(Value&& value)
+            {
+                size_t hash = mix_hash(_hash(KeyOf()(value)));
+                size_t index = free_slot(hash);
+                new (static_cast<void*>(_slots + index)) Slot(std::forward<Value>(value));
+                set_control(index, hash_bits(hash));
+                ++_size;
+            }
+
+            void rehash(size_t capacity)
+            {
+                FlatTable old(_hash, _equal);
+                swap(old);
+
+                _capacity = capacity;
+                _controls.reset(new control_byte[capacity + group_width - 1]);
+                std::fill(_controls.get(), _controls.get() + capacity + group_width - 1, control_empty);
+                _slots = std::allocator<Slot>().allocate(capacity);
+
+                for (auto& slot : old)
+                    insert_unique(std::move(slot));
+            }
+
+            void destroy()
+            {
+                if (_slots == nullptr)
+                    return;
+
+                for (auto& slot : *this)
+                    slot.~Slot();
+                std::allocator<Slot>().deallocate(_slots, _capacity);
+                _slots = nullptr;
+                _controls.reset();
+            }
+
+            size_t _capacity;
+            size_t _size;
+            size_t _deleted;
+            std::unique_ptr<control_byte[]> _controls;
+            Slot* _slots;
+            Hash _hash;
+            Equal _equal;
+        };
+
+        struct SlotIsKey
+        {
+            template <typename T>
+            const T& operator () (const T& value) const
+            {
+                return value;
+            }
+        };
+
+        struct SlotFirstIsKey
+        {
+            template <typename Pair>
+            const auto& operator () (const Pair& pair) const
+            {
+                return pair.first;
+            }
+        };
+    }
+
+#pragma endregion
+
+#pragma region FlatHashSet
+
+    // A hash set over a flat table, with the interface of std::unordered_set for insertion and lookups.
+    // Inserting elements invalidates iterators and references to the others, and erasing keeps them valid.
+    template <typename T, typename Hash = std::hash<T>, typename Equal = std::equal_to<T>>
+    class FlatHashSet
+    {
+        using table_type = details::FlatTable<T, details::SlotIsKey, Hash, Equal>;
+
+    public:
+
+        using value_type = T;
+        using key_type = T;
+        using size_type = size_t;
+        using hasher = Hash;
+        using key_equal = Equal;
+        using iterator = typename table_type::const_iterator;
+        using const_iterator = typename table_type::const_iterator;
+
+        FlatHashSet(const Hash& hash = Hash(), const Equal& equal = Equal()) :
+            _table(hash, equal)
+        {}
+
+        FlatHashSet(std::initializer_list<T> values)
+        {
+            _table.reserve(values.size());
+            for (const auto& value : values)
+                insert(value);
+        }
+
+        const_iterator begin() const { return _table.begin(); }
+        const_iterator end() const { return _table.end(); }
+
+        size_t size() const { return _table.size(); }
+        bool empty() const { return _table.size() == 0; }
+
+        void reserve(size_t count) { _table.reserve(count); }
+        void clear() { _table.clear(); }
+
+        std::pair<const_iterator, bool> insert(const T& value)
+        {
+            return emplace(value);
+        }
+
+        std::pair<const_iterator, bool> insert(T&& value)
+        {
+            return emplace(std::move(value));
+        }
+
+        // Unlike std::unordered_set, takes the element itself rather than the arguments of its constructor
+        template <typename Value>
+        std::pair<const_iterator, bool> emplace(Value&& value)
+        {
+            return _table.find_or_construct(value, [&](void* memory)
+            {
+                new (memory) T(std::forward<Value>(value));
+            });
+        }
+
+        const_iterator find(const T& value) const
+        {
+            return _table.find(value);
+        }
+
+        bool contains(const T& value) const
+        {
+            return _table.find(value) != _table.end();
+        }
+
+        size_t count(const T& value) const
+        {
+            return contains(value) ? 1 : 0;
+        }
+
+        size_t erase(const T& value)
+        {
+            return _table.erase(value);
+        }
+
+        // Moves the elements of other that are missing, and empties other
+        void merge(FlatHashSet& other)
+        {
+            _table.merge(other._table);
+        }
+
+        bool operator == (const FlatHashSet& other) const
+        {
+            if (size() != other.size())
+                return false;
+            for (const auto& value : *this)
+            {
+                if (!other.contains(value))
+                    return false;
+            }
+            return true;
+        }
+
+        bool operator != (const FlatHashSet& other) const
+        {
+            return !(*this == other);
+        }
+
+    private:
+
+        table_type _table;
+    };
+
+#pragma endregion
+
+#pragma region FlatHashMap
+
+    // A hash map over a flat table, with the interface of std::unordered_map for insertion and lookups.
+    // Unlike std::unordered_map, the elements are std::pair<Key, Value>, whose keys must not be modified through iterators.
+    // Inserting elements invalidates iterators and references to the others, and erasing keeps them valid.
+    template <typename Key, typename Value, typename Hash = std::hash<Key>, typename Equal = std::equal_to<Key>>
+    class FlatHashMap
+    {
+        using table_type = details::FlatTable<std::pair<Key, Value>, details::SlotFirstIsKey, Hash, Equal>;
+
+    public:
+
+        using key_type = Key;
+        using mapped_type = Value;
+        using value_type = std::pair<Key, Value>;
+        using size_type = size_t;
+        using hasher = Hash;
+        using key_equal = Equal;
+        using iterator = typename table_type::iterator;
+        using const_iterator = typename table_type::const_iterator;
+
+        FlatHashMap(const Hash& hash = Hash(), const Equal& equal = Equal()) :
+            _table(hash, equal)
+        {}
+
+        FlatHashMap(std::initializer_list<value_type> values)
+        {
+            _table.reserve(values.size());
+            for (const auto& value : values)
+                try_emplace(value.first, value.second);
+        }
+
+        iterator begin() { return _table.begin(); }
+        iterator end() { return _table.end(); }
+        const_iterator begin() const { return _table.begin(); }
+        const_iterator end() const { return _table.end(); }
+
+        size_t size() const { return _table.size(); }
+        bool empty() const { return _table.size() == 0; }
+
+        void reserve(size_t count) { _table.reserve(count); }
+        void clear() { _table.clear(); }
+
+        // Inserts the key with a value built from the arguments, unless the key is present
+        template <typename K, typename... Args>
+        std::pair<iterator, bool> try_emplace(K&& key, Args&&... args)
+        {
+            return find_or_insert_with(std::forward<K>(key), [&] { return Value(std::forward<Args>(args)...); });
+        }
+
+        // Looks for the key, and when it is missing inserts it with the value returned by make(). 
+        // Hashes the key once either way.
+        template <typename K, typename Make>
+        std::pair<iterator, bool> find_or_insert_with(K&& key, Make&& make)
+        {
+            return _table.find_or_construct(key, [&](void* memory)
+            {
+                new (memory) value_type(std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)), std::forward_as_tuple(make()));
+            });
+        }
+
+        Value& operator [] (const Key& key)
+        {
+            return try_emplace(key).first->second;
+        }
+
+        iterator find(const Key& key)
+        {
+            return _table.find(key);
+        }
+
+        const_iterator find(const Key& key) const
+        {
+            return _table.find(key);
+        }
+
+        bool contains(const Key& key) const
+        {
+            return _table.find(key) != _table.end();
+        }
+
+        size_t count(const Key& key) const
+        {
+            return contains(key) ? 1 : 0;
+        }
+
+        size_t erase(const Key& key)
+        {
+            return _table.erase(key);
+        }
+
+    private:
+
+        table_type _table;
+    };
+
+#pragma endregion
+}
@@ -0,0 +1,514 @@
+#pragma once
+
+#include "forward-basics.h"
+
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace forward
+{
+    // CONTAINS:
+    // lines
+    // files
+    //
+    // Enumerables over the file system.
+
+#pragma region Memory mapped files
+
+    // A read-only mapping of a whole file, which the system is told will be read sequentially,
+    // so that it reads ahead and drops the pages already read first: files larger than the memory can be mapped.
+    // Throws std::system_error if the file cannot be opened or mapped.
+    class MappedFile
+    {
+    public:
+
+        explicit MappedFile(const std::filesystem::path& path) :
+            _data(nullptr),
+            _size(0)
+        {
+#if defined(_WIN32)
+            HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+                fail(GetLastError(), std::system_category(), "cannot open", path);
+
+            LARGE_INTEGER size;
+            if (!GetFileSizeEx(file, &size))
+            {
+                auto error = GetLastError();
+                CloseHandle(file);
+                fail(error, std::system_category(), "cannot get the size of", path);
+            }
+            _size = static_cast<size_t>(size.QuadPart);
+
+            // Empty files cannot be mapped
+            if (_size != 0)
+            {
+                HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+                auto error = GetLastError();
+                if (mapping)
+                    CloseHandle(mapping);
+                if (!data)
+                {
+                    CloseHandle(file);
+                    fail(error, std::system_category(), "cannot map", path);
+                }
+                _data = static_cast<const char*>(data);
+            }
+
+            // The view keeps the file open
+            CloseHandle(file);
+#else
+            int file = ::open(path.c_str(), O_RDONLY);
+            if (file < 0)
+                fail(errno, std::generic_category(), "cannot open", path);
+
+            struct stat status;
+            if (::fstat(file, &status) != 0)
+            {
+                int error = errno;
+                ::close(file);
+                fail(error, std::generic_category(), "cannot get the size of", path);
+            }
+            _size = static_cast<size_t>(status.st_size);
+
+            // Empty files cannot be mapped
+            if (_size != 0)
+            {
+                void* data = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, file, 0);
+                if (data == MAP_FAILED)
+                {
+                    int error = errno;
+                    ::close(file);
+                    fail(error, std::generic_category(), "cannot map", path);
+                }
+                ::madvise(data, _size, MADV_SEQUENTIAL);
+                _data = static_cast<const char*>(data);
+            }
+
+            // The mapping keeps the file open
+            ::close(file);
+#endif
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator = (const MappedFile&) = delete;
+
+        ~MappedFile()
+        {
+            if (_data == nullptr)
+                return;
+#if defined(_WIN32)
+            UnmapViewOfFile(_data);
+#else
+            ::munmap(const_cast<char*>(_data), _size);
+#endif
+        }
+
+        const char* data() const
+        {
+            return _data;
+        }
+
+        size_t size() const
+        {
+            return _size;
+        }
+
+    private:
+
+        template <typename Error>
+        [[noreturn]] static void fail(Error error, const std::error_category& category, const char* what, const std::filesystem::path& path)
+        {
+            throw std::system_error(static_cast<int>(error), category, std::string(what) + " " + path.string());
+        }
+
+        const char* _data;
+        size_t _size;
+    };
+
+#pragma endregion
+
+#pragma region Lines
+
+    namespace details
+    {
+        // The line starting at current, without its end of line ("\n" or "\r\n"), and moves current to the next one.
+        // memchr is vectorized by the standard libraries.
+        inline std::string_view next_line(const char*& current, const char* end)
+        {
+            auto found = static_cast<const char*>(std::memchr(current, '\n', static_cast<size_t>(end - current)));
+            const char* line_end = found ? found : end;
+
+            std::string_view line(current, static_cast<size_t>(line_end - current));
+            if (!line.empty() && line.back() == '\r')
+                line.remove_suffix(1);
+
+            current = found ? found + 1 : end;
+            return line;
+        }
+    }
+
+    class LinesEnumerator
+    {
+    public:
+
+        static const bool is_enumerator = true;
+
+        LinesEnumerator(const char* current, const char* end) :
+            _current(current),
+            _end(end)
+        {}
+
+        auto next()
+        {
+            if (_current == _end)
+                return yield_none<std::string_view>();
+            else
+                return yield_some(details::next_line(_current, _end));
+        }
+
+    private:
+
+        const char* _current;
+        const char* _end;
+    };
+
+    // The lines of a text file, as views into a mapping of the file: nothing is copied or allocated per line.
+    // The views are valid as long as a copy of the enumerable exists; select a std::string to keep a line longer.
+    // A last line without an end of line is enumerated, and an empty one is not, as with std::getline.
+    //
+    // Splittable by bytes of the file: a range of positions pushes the lines that start within it.
+    class LinesEnumerable
+    {
+    public:
+
+        static const bool is_enumerable = true;
+        using enumerator = LinesEnumerator;
+
+        LinesEnumerable(std::shared_ptr<const MappedFile> file) :
+            _file(std::move(file))
+        {
+        }
+
+        enumerator get_enumerator() const
+        {
+            return enumerator(_file->data(), _file->data() + _file->size());
+        }
+
+        template <typename Sink>
+        void push_to(Sink& sink) const
+        {
+            push_range(0, _file->size(), sink);
+        }
+
+        size_t source_size() const
+        {
+            return _file->size();
+        }
+
+        template <typename Sink>
+        void push_range(size_t first, size_t last, Sink& sink) const
+        {
+            const char* data = _file->data();
+            const char* end = data + _file->size();
+            const char* current = data + first;
+
+            // The line in progress at first belongs to the previous range
+            if (first != 0 && data[first - 1] != '\n')
+            {
+                auto found = static_cast<const char*>(std::memchr(current, '\n', static_cast<size_t>(end - current)));
+                current = found ? found + 1 : end;
+            }
+
+            for (const char* stop = data + last; current < stop;)
+                sink(details::next_line(current, end));
+        }
+
+    private:
+
+        std::shared_ptr<const MappedFile> _file;
+    };
+
+    inline LinesEnumerable lines(const std::filesystem::path& path)
+    {
+        return LinesEnumerable(std::make_shared<const MappedFile>(path));
+    }
+
+#pragma endregion
+
+#pragma region Files
+
+    namespace details
+    {
+        // Lists directories on several threads, and queues the regular files found for a single consumer.
+        // The queue is bounded, so that the walkers wait for the consumer rather than holding a whole tree in memory.
+        // Directories waiting to be listed are not bounded, but there are far fewer of them than files.
+        class ParallelWalk
+        {
+        public:
+
+            ParallelWalk(const std::filesystem::path& root, unsigned walkers, size_t capacity) :
+                _root(root),
+                _capacity(capacity),
+                _busy(0),
+                _stopped(false)
+            {
+                _directories.push_back(root);
+                for (unsigned i = 0; i < walkers; ++i)
+                    _walkers.emplace_back([this] { walk(); });
+            }
+
+            ParallelWalk(const ParallelWalk&) = delete;
+            ParallelWalk& operator = (const ParallelWalk&) = delete;
+
+            // Stops the walkers, when the consumer is done early
+            ~ParallelWalk()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _stopped = true;
+                }
+                _walker_wake.notify_all();
+
+                for (auto& walker : _walkers)
+                    walker.join();
+            }
+
+            // The next file, or nothing once the whole tree is listed. Rethrows the first error of the walkers.
+            std::optional<std::filesystem::path> pop()
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _consumer_wake.wait(lock, [&] { return !_files.empty() || _error || finished(); });
+
+                if (_error)
+                    std::rethrow_exception(_error);
+                if (_files.empty())
+                    return std::nullopt;
+
+                bool was_full = _files.size() == _capacity;
+                std::optional<std::filesystem::path> result(std::move(_files.front()));
+                _files.pop_front();
+                lock.unlock();
+
+                if (was_full)
+                    _walker_wake.notify_all();
+                return result;
+            }
+
+        private:
+
+            bool finished() const
+            {
+                return _directories.empty() && _busy == 0;
+            }
+
+            void walk()
+            {
+                for (;;)
+                {
+                    std::filesystem::path directory;
+                    {
+                        std::unique_lock<std::mutex> lock(_mutex);
+                        _walker_wake.wait(lock, [&] { return _stopped || !_directories.empty() || _busy == 0; });
+                        if (_stopped || _directories.empty())
+                            return;
+
+                        directory = std::move(_directories.back());
+                        _directories.pop_back();
+                        ++_busy;
+                    }
+
+                    try
+                    {
+                        list(directory);
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        if (!_error)
+                            _error = std::current_exception();
+                        _stopped = true;
+                    }
+
+                    {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        --_busy;
+                    }
+                    _walker_wake.notify_all();
+                    _consumer_wake.notify_one();
+                }
+            }
+
+            // Subdirectories that cannot be read, or that disappear while they are listed, are skipped.
+            // The root is not: as with a sequential traversal, failing to open it is an error.
+            void list(const std::filesystem::path& directory)
+            {
+                using namespace std::filesystem;
+
+                std::error_code error;
+                directory_iterator entries(directory, directory_options::skip_permission_denied, error);
+                if (error && directory == _root)
+                    throw filesystem_error("cannot list the directory", directory, error);
+
+                for (; !error && entries != directory_iterator(); entries.increment(error))
+                {
+                    const auto& entry = *entries;
+                    std::error_code status;
+                    if (entry.is_directory(status) && !entry.is_symlink(status))
+                    {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        if (_stopped)
+                            return;
+                        _directories.push_back(entry.path());
+                        _walker_wake.notify_one();
+                    }
+                    else if (entry.is_regular_file(status))
+                    {
+                        std::unique_lock<std::mutex> lock(_mutex);
+                        _walker_wake.wait(lock, [&] { return _stopped || _files.size() < _capacity; });
+                        if (_stopped)
+                            return;
+                        _files.push_back(entry.path());
+                        lock.unlock();
+                        _consumer_wake.notify_one();
+                    }
+                }
+            }
+
+            std::filesystem::path _root;
+            size_t _capacity;
+            std::deque<std::filesystem::path> _files;
+            std::vector<std::filesystem::path> _directories;
+            size_t _busy;
+            bool _stopped;
+            std::exception_ptr _error;
+            std::mutex _mutex;
+            std::condition_variable _walker_wake;
+            std::condition_variable _consumer_wake;
+            std::vector<std::thread> _walkers;
+        };
+    }
+
+    // The capacity of the queue between the walkers of a parallel traversal and the enumerator
+    const size_t files_queue_capacity = 4096;
+
+    class FilesEnumerator
+    {
+    public:
+
+        static const bool is_enumerator = true;
+
+        // Lists the directory on the calling thread, one entry at a time
+        FilesEnumerator(const std::filesystem::path& root, bool recursive) :
+            _current(root, std::filesystem::directory_options::skip_permission_denied),
+            _recursive(recursive)
+        {}
+
+        FilesEnumerator(const std::filesystem::path& root, unsigned walkers) :
+            _recursive(true),
+            _walk(std::make_unique<details::ParallelWalk>(root, walkers, files_queue_capacity))
+        {}
+
+        auto next()
+        {
+            if (_walk)
+                return _walk->pop();
+
+            for (; _current != std::filesystem::recursive_directory_iterator(); advance())
+            {
+                std::error_code error;
+                if (_current->is_regular_file(error))
+                {
+                    std::optional<std::filesystem::path> result(_current->path());
+                    advance();
+                    return result;
+                }
+            }
+            return yield_none<std::filesystem::path>();
+        }
+
+    private:
+
+        void advance()
+        {
+            if (!_recursive)
+                _current.disable_recursion_pending();
+            ++_current;
+        }
+
+        std::filesystem::recursive_directory_iterator _current;
+        bool _recursive;
+        std::unique_ptr<details::ParallelWalk> _walk;
+    };
+
+    // The paths of the regular files of a directory, and of its subdirectories if recursive, listed lazily:
+    // the tree is never held in memory. Symbolic links to directories are not followed,
+    // and directories that cannot be read are skipped. With a single walker, only those that deny permission are:
+    // other errors, such as a subdirectory removed during the traversal, throw.
+    //
+    // With more than one walker, the subdirectories are listed concurrently by that many threads,
+    // which queue the files they find for the enumerator, in no particular order.
+    // The threads start with every enumeration, and stop when the enumerator is destroyed.
+    class FilesEnumerable
+    {
+    public:
+
+        static const bool is_enumerable = true;
+        using enumerator = FilesEnumerator;
+
+        FilesEnumerable(std::filesystem::path root, bool recursive, unsigned walkers) :
+            _root(std::move(root)),
+            _recursive(recursive),
+            _walkers(walkers)
+        {}
+
+        enumerator get_enumerator() const
+        {
+            if (_recursive && _walkers > 1)
+                return enumerator(_root, _walkers);
+            else
+                return enumerator(_root, _recursive);
+        }
+
+    private:
+
+        std::filesystem::path _root;
+        bool _recursive;
+        unsigned _walkers;
+    };
+
+    inline FilesEnumerable files(const std::filesystem::path& root, bool recursive = false, unsigned walkers = 1)
+    {
+        return FilesEnumerable(root, recursive, walkers);
+    }
+
+#pragma endregion
+}
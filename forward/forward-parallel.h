@@ -0,0 +1,671 @@
+#pragma once
+
+#include "forward-basics.h"
+#include "forward-hash.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace forward
+{
+    // CONTAINS:
+    // ThreadPool
+    // parallel
+    // to_vector, sum_from, to_set, to_groups, group_by over parallel enumerables
+
+#pragma region Thread pool
+
+    // A pool of worker threads that run ranges of positions, balanced by work stealing.
+    // Every worker owns a deque of ranges. It splits the range it runs in halves down to a grain size,
+    // pushing the second halves to the back of its deque and going on with the first ones,
+    // and takes its next range from the back of its deque.
+    // Workers whose deque is empty steal from the front of the other deques, where the largest ranges are.
+    // Threads outside the pool that wait for a parallel_for help running ranges in the meantime.
+    class ThreadPool
+    {
+    public:
+
+        explicit ThreadPool(size_t thread_count = std::thread::hardware_concurrency()) :
+            _queued(0),
+            _stopping(false)
+        {
+            thread_count = std::max<size_t>(thread_count, 1);
+
+            // One deque per worker, and a last one shared by the threads outside the pool
+            for (size_t i = 0; i <= thread_count; ++i)
+                _queues.push_back(std::make_unique<Queue>());
+
+            for (size_t i = 0; i < thread_count; ++i)
+                _threads.emplace_back([this, i] { work(i); });
+        }
+
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_sleep_mutex);
+                _stopping = true;
+            }
+            _wake.notify_all();
+
+            for (auto& thread : _threads)
+                thread.join();
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator = (const ThreadPool&) = delete;
+
+        // The pool used by default, started on first use and reused by all the queries that follow
+        static ThreadPool& shared()
+        {
+            static ThreadPool pool;
+            return pool;
+        }
+
+        size_t thread_count() const
+        {
+            return _threads.size();
+        }
+
+        // Calls body(first, last) on disjoint ranges of at most grain positions that cover [0, size),
+        // and returns when they have all run. Rethrows the first exception thrown by the body, if any.
+        template <typename Body>
+        void parallel_for(size_t size, size_t grain, const Body& body)
+        {
+            if (size == 0)
+                return;
+
+            struct BodyJob : Job
+            {
+                BodyJob(size_t size, size_t grain, const Body& body) :
+                    Job(size, grain),
+                    _body(body)
+                {}
+
+                void run(size_t first, size_t last) override
+                {
+                    _body(first, last);
+                }
+
+                const Body& _body;
+            };
+
+            BodyJob job(size, std::max<size_t>(grain, 1), body);
+            size_t queue = current_queue();
+
+            execute(queue, Task{ &job, 0, size });
+            wait(queue, job);
+
+            if (job.error)
+                std::rethrow_exception(job.error);
+        }
+
+    private:
+
+        struct Job
+        {
+            Job(size_t size, size_t grain) :
+                grain(grain),
+                remaining(size),
+                failed(false)
+            {}
+
+            virtual ~Job() = default;
+            virtual void run(size_t first, size_t last) = 0;
+
+            const size_t grain;
+            size_t remaining; // guarded by mutex
+            std::atomic<bool> failed;
+            std::exception_ptr error; // guarded by mutex
+            std::mutex mutex;
+            std::condition_variable done;
+        };
+
+        struct Task
+        {
+            Job* job;
+            size_t first;
+            size_t last;
+        };
+
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        struct Identity
+        {
+            const ThreadPool* pool = nullptr;
+            size_t index = 0;
+        };
+
+        static Identity& identity()
+        {
+            static thread_local Identity current;
+            return current;
+        }
+
+        size_t current_queue() const
+        {
+            return identity().pool == this ? identity().index : _queues.size() - 1;
+        }
+
+        void push(size_t queue, Task task)
+        {
+            {
+                std::lock_guard<std::mutex> lock(_queues[queue]->mutex);
+                _queues[queue]->tasks.push_back(task);
+            }
+            ++_queued;
+
+            {
+                std::lock_guard<std::mutex> lock(_sleep_mutex);
+            }
+            _wake.notify_one();
+        }
+
+        bool pop(size_t queue, Task& task)
+        {
+            std::lock_guard<std::mutex> lock(_queues[queue]->mutex);
+            auto& tasks = _queues[queue]->tasks;
+            if (tasks.empty())
+                return false;
+
+            task = tasks.back();
+            tasks.pop_back();
+            --_queued;
+            return true;
+        }
+
+        bool steal(size_t thief, Task& task)
+        {
+            for (size_t i = 1; i < _queues.size(); ++i)
+            {
+                size_t victim = (thief + i) % _queues.size();
+                std::lock_guard<std::mutex> lock(_queues[victim]->mutex);
+                auto& tasks = _queues[victim]->tasks;
+                if (tasks.empty())
+                    continue;
+
+                task = tasks.front();
+                tasks.pop_front();
+                --_queued;
+                return true;
+            }
+            return false;
+        }
+
+        bool find(size_t queue, Task& task)
+        {
+            return pop(queue, task) || steal(queue, task);
+        }
+
+        // Runs the first grain of the task, after pushing the rest of it in halves
+        void execute(size_t queue, Task task)
+        {
+            Job& job = *task.job;
+
+            while (task.last - task.first > job.grain)
+            {
+                size_t middle = task.first + (task.last - task.first) / 2;
+                push(queue, Task{ &job, middle, task.last });
+                task.last = middle;
+            }
+
+            if (!job.failed)
+            {
+                try
+                {
+                    job.run(task.first, task.last);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(job.mutex);
+                    if (!job.error)
+                        job.error = std::current_exception();
+                    job.failed = true;
+                }
+            }
+
+            // The job may be destroyed as soon as this lock is released
+            std::lock_guard<std::mutex> lock(job.mutex);
+            job.remaining -= task.last - task.first;
+            if (job.remaining == 0)
+                job.done.notify_all();
+        }
+
+        void wait(size_t queue, Job& job)
+        {
+            for (;;)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(job.mutex);
+                    if (job.remaining == 0)
+                        return;
+                }
+
+                Task task;
+                if (find(queue, task))
+                {
+                    execute(queue, task);
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(job.mutex);
+                if (job.done.wait_for(lock, std::chrono::milliseconds(1), [&] { return job.remaining == 0; }))
+                    return;
+            }
+        }
+
+        void work(size_t index)
+        {
+            identity() = Identity{ this, index };
+
+            for (;;)
+            {
+                Task task;
+                if (find(index, task))
+                {
+                    execute(index, task);
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(_sleep_mutex);
+                _wake.wait(lock, [&] { return _stopping || _queued != 0; });
+                if (_stopping && _queued == 0)
+                    return;
+            }
+        }
+
+        std::vector<std::unique_ptr<Queue>> _queues;
+        std::vector<std::thread> _threads;
+        std::atomic<size_t> _queued;
+        std::mutex _sleep_mutex;
+        std::condition_variable _wake;
+        bool _stopping; // guarded by _sleep_mutex
+    };
+
+#pragma endregion
+
+#pragma region Parallel enumerable
+
+    // Marks the end of a chain of stages that the accumulators may run in parallel, for instance:
+    //
+    // from(v) >> where(...) >> select(...) >> parallel() >> to_vector<T>()
+    //
+    // When the chain is splittable (a range, or an iteratable with random access iterators,
+    // followed by any number of where and select) the accumulators split the source in chunks,
+    // run the chain over the chunks on the workers of a thread pool and merge the results in order.
+    // Otherwise they run sequentially. The stages of the chain must be safe to call concurrently.
+    template <typename Enumerable>
+    class ParallelEnumerable
+    {
+    public:
+
+        static const bool is_enumerable = true;
+        using enumerator = decltype(std::declval<const Enumerable&>().get_enumerator());
+
+        ParallelEnumerable(Enumerable enumerable, ThreadPool& pool) :
+            _enumerable(std::move(enumerable)),
+            _pool(&pool)
+        {
+        }
+
+        enumerator get_enumerator() const
+        {
+            return _enumerable.get_enumerator();
+        }
+
+        template <typename Sink>
+        void push_to(Sink& sink) const
+        {
+            for_each(_enumerable, sink);
+        }
+
+        std::optional<SizeHint> size_hint() const
+        {
+            return get_size_hint(_enumerable);
+        }
+
+        const Enumerable& sequential() const
+        {
+            return _enumerable;
+        }
+
+        ThreadPool& pool() const
+        {
+            return *_pool;
+        }
+
+    private:
+
+        Enumerable _enumerable;
+        ThreadPool* _pool;
+    };
+
+    class Parallel
+    {
+    public:
+
+        Parallel(ThreadPool& pool) :
+            _pool(&pool)
+        {}
+
+        template <typename Enumerable>
+        ParallelEnumerable<std::decay_t<Enumerable>> apply(Enumerable&& enumerable) const
+        {
+            return ParallelEnumerable<std::decay_t<Enumerable>>(std::forward<Enumerable>(enumerable), *_pool);
+        }
+
+    private:
+
+        ThreadPool* _pool;
+    };
+
+    template <typename Enumerable>
+    ParallelEnumerable<std::decay_t<Enumerable>> operator >> (Enumerable&& enumerable, const Parallel& parallel)
+    {
+        return parallel.apply(std::forward<Enumerable>(enumerable));
+    }
+
+    inline Parallel parallel(ThreadPool& pool = ThreadPool::shared())
+    {
+        return Parallel(pool);
+    }
+
+#pragma endregion
+
+#pragma region Chunked execution
+
+    // How many ranges, on average, the source is split into for every worker.
+    // Ranges smaller than a static share of the source let the pool balance filters of skewed selectivity.
+    const size_t ranges_per_thread = 16;
+
+    namespace details
+    {
+        // Splits the source of a splittable enumerable in ranges run on the pool,
+        // and returns the results of fold(first, last) over every range, in the order of the source.
+        template <typename Enumerable, typename Fold>
+        auto fold_ranges(const Enumerable& enumerable, ThreadPool& pool, const Fold& fold)
+        {
+            using result_type = decltype(fold(size_t(), size_t()));
+
+            size_t size = enumerable.source_size();
+            size_t grain = std::max<size_t>(1, size / (pool.thread_count() * ranges_per_thread));
+
+            std::mutex mutex;
+            std::vector<std::pair<size_t, result_type>> partials;
+
+            pool.parallel_for(size, grain, [&](size_t first, size_t last)
+            {
+                auto result = fold(first, last);
+                std::lock_guard<std::mutex> lock(mutex);
+                partials.emplace_back(first, std::move(result));
+            });
+
+            std::sort(partials.begin(), partials.end(), [](const auto& a, const auto& b)
+            {
+                return a.first < b.first;
+            });
+
+            std::vector<result_type> results;
+            results.reserve(partials.size());
+            for (auto& partial : partials)
+                results.push_back(std::move(partial.second));
+
+            return results;
+        }
+    }
+
+#pragma endregion
+
+#pragma region Parallel accumulators
+
+    template <typename Enumerable>
+    auto to_vector(const ParallelEnumerable<Enumerable>& parallel)
+    {
+        const auto& enumerable = parallel.sequential();
+
+        if constexpr (details::is_splittable<Enumerable>::value)
+        {
+            using stored_type = enumerated_type<decltype(enumerable.get_enumerator())>;
+
+            auto chunks = details::fold_ranges(enumerable, parallel.pool(), [&](size_t first, size_t last)
+            {
+                std::vector<stored_type> result;
+                auto sink = [&](auto&& value)
+                {
+                    result.push_back(std::forward<decltype(value)>(value));
+                };
+                enumerable.push_range(first, last, sink);
+                return result;
+            });
+
+            size_t total = 0;
+            for (const auto& chunk : chunks)
+                total += chunk.size();
+
+            std::vector<stored_type> result;
+            result.reserve(total);
+            for (auto& chunk : chunks)
+                std::move(chunk.begin(), chunk.end(), std::back_inserter(result));
+
+            return result;
+        }
+        else
+        {
+            return to_vector(enumerable);
+        }
+    }
+
+    // Every range is summed from a value-initialized T, and zero is added once, before the sums of the ranges in their order.
+    // Floating point values may then be rounded differently than when added one after the other.
+    template <typename Enumerable, typename T>
+    auto sum_from(const ParallelEnumerable<Enumerable>& parallel, T zero)
+    {
+        const auto& enumerable = parallel.sequential();
+
+        if constexpr (details::is_splittable<Enumerable>::value)
+        {
+            auto partials = details::fold_ranges(enumerable, parallel.pool(), [&](size_t first, size_t last)
+            {
+                T result{};
+                auto sink = [&](const auto& value)
+                {
+                    result = result + value;
+                };
+                enumerable.push_range(first, last, sink);
+                return result;
+            });
+
+            T result = std::move(zero);
+            for (auto& partial : partials)
+                result = result + partial;
+
+            return result;
+        }
+        else
+        {
+            return sum_from(enumerable, std::move(zero));
+        }
+    }
+
+    template <typename Enumerable>
+    auto to_set(const ParallelEnumerable<Enumerable>& parallel)
+    {
+        const auto& enumerable = parallel.sequential();
+
+        if constexpr (details::is_splittable<Enumerable>::value)
+        {
+            using stored_type = enumerated_type<decltype(enumerable.get_enumerator())>;
+
+            auto partials = details::fold_ranges(enumerable, parallel.pool(), [&](size_t first, size_t last)
+            {
+                FlatHashSet<stored_type> result;
+                auto sink = [&](auto&& value)
+                {
+                    result.insert(std::forward<decltype(value)>(value));
+                };
+                enumerable.push_range(first, last, sink);
+                return result;
+            });
+
+            // Merged into the largest chunk, which already holds the most elements
+            FlatHashSet<stored_type> result;
+            if (!partials.empty())
+            {
+                auto largest = std::max_element(partials.begin(), partials.end(), [](const auto& a, const auto& b)
+                {
+                    return a.size() < b.size();
+                });
+                result = std::move(*largest);
+            }
+            for (auto& partial : partials)
+                result.merge(partial);
+
+            return result;
+        }
+        else
+        {
+            return to_set(enumerable);
+        }
+    }
+
+#pragma endregion
+
+#pragma region Parallel group by
+
+    // The groups of a parallel group by are partitioned by the high bits of a second hash of their keys
+    const size_t group_partition_bits = 6;
+
+    // How many groups every range of the source aggregates in its local table before spilling them to the partitions:
+    // few enough for the table to stay in cache, enough for the frequent keys to be aggregated once per range
+    const size_t group_spill_threshold = 1 << 14;
+
+    namespace details
+    {
+        // Mixed with another multiplier than mix_hash, whose bits give the positions in the tables of the partitions:
+        // with a 32-bit size_t, the high bits of mix_hash are also those of the positions in large tables, 
+        // and all the keys of a partition would crowd into a fraction of its table.
+        template <typename Key>
+        size_t group_partition(const Key& key)
+        {
+            std::uint64_t mixed = static_cast<std::uint64_t>(std::hash<Key>()(key)) * 0xD6E8FEB86659FD93ull;
+            return static_cast<size_t>(mixed >> (64 - group_partition_bits));
+        }
+
+        // The groups of a parallel enumerable, in disjoint partitions aggregated in two phases on the pool.
+        // Every range of the source runs the splittable chain into a small local table, which spills its groups
+        // into one buffer per partition whenever it is full. The partitions are then merged in parallel, 
+        // each into its own table, a fraction of the size of a single one.
+        template <typename Enumerable, typename KeySelector, typename Aggregator>
+        auto group_partitions(const ParallelEnumerable<Enumerable>& parallel, const KeySelector& key, const Aggregator& aggregator)
+        {
+            const auto& enumerable = parallel.sequential();
+
+            if constexpr (is_splittable<Enumerable>::value)
+            {
+                using stored_type = enumerated_type<decltype(enumerable.get_enumerator())>;
+                using key_type = std::decay_t<decltype(key(std::declval<const stored_type&>()))>;
+                using state_type = std::decay_t<decltype(aggregator.start(std::declval<const stored_type&>()))>;
+                using groups_type = FlatHashMap<key_type, state_type>;
+                using spill_type = std::vector<typename groups_type::value_type>;
+
+                const size_t partition_count = size_t(1) << group_partition_bits;
+
+                auto spills = fold_ranges(enumerable, parallel.pool(), [&](size_t first, size_t last)
+                {
+                    std::vector<spill_type> partitions(partition_count);
+                    groups_type local;
+
+                    auto spill = [&]
+                    {
+                        for (auto& group : local)
+                            partitions[group_partition(group.first)].push_back(std::move(group));
+                        local.clear();
+                    };
+
+                    auto sink = [&](const auto& value)
+                    {
+                        auto found = local.find_or_insert_with(key(value), [&] { return aggregator.start(value); });
+                        if (!found.second)
+                            aggregator.add(found.first->second, value);
+                        else if (local.size() == group_spill_threshold)
+                            spill();
+                    };
+
+                    enumerable.push_range(first, last, sink);
+                    spill();
+                    return partitions;
+                });
+
+                std::vector<groups_type> groups(partition_count);
+                parallel.pool().parallel_for(partition_count, 1, [&](size_t first, size_t last)
+                {
+                    for (size_t partition = first; partition < last; ++partition)
+                    {
+                        auto& merged = groups[partition];
+                        for (auto& range : spills)
+                        {
+                            for (auto& group : range[partition])
+                            {
+                                auto found = merged.find_or_insert_with(std::move(group.first), [&] { return std::move(group.second); });
+                                if (!found.second)
+                                    aggregator.merge(found.first->second, std::move(group.second));
+                            }
+                            spill_type().swap(range[partition]);
+                        }
+                    }
+                });
+
+                return groups;
+            }
+            else
+            {
+                std::vector<decltype(to_groups(enumerable, key, aggregator))> groups;
+                groups.push_back(to_groups(enumerable, key, aggregator));
+                return groups;
+            }
+        }
+    }
+
+    // The partitions are moved into a single table, sequentially, as the result must be one hash map.
+    // group_by over a parallel enumerable enumerates the partitions one after the other instead.
+    template <typename Enumerable, typename KeySelector, typename Aggregator>
+    auto to_groups(const ParallelEnumerable<Enumerable>& parallel, const KeySelector& key, const Aggregator& aggregator)
+    {
+        auto partitions = details::group_partitions(parallel, key, aggregator);
+
+        size_t total = 0;
+        for (const auto& partition : partitions)
+            total += partition.size();
+
+        // The largest partition is kept, and the others, whose keys are all different, are moved into it
+        auto largest = std::max_element(partitions.begin(), partitions.end(), [](const auto& a, const auto& b)
+        {
+            return a.size() < b.size();
+        });
+        auto result = std::move(*largest);
+        result.reserve(total);
+
+        for (auto& partition : partitions)
+        {
+            for (auto& group : partition)
+                result.find_or_insert_with(std::move(group.first), [&] { return std::move(group.second); });
+        }
+
+        return result;
+    }
+
+#pragma endregion
+}
@@ -0,0 +1,280 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define FORWARD_X64
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// Code using the instructions of a given extension must be marked as such for GCC and Clang.
+// MSVC accepts the intrinsics of every extension anywhere.
+#if defined(FORWARD_X64) && (defined(__GNUC__) || defined(__clang__))
+#define FORWARD_TARGET_AVX2 __attribute__((target("avx2")))
+#define FORWARD_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define FORWARD_TARGET_AVX2
+#define FORWARD_TARGET_AVX512
+#endif
+
+namespace forward
+{
+    // CONTAINS:
+    // sum_array
+    //
+    // Kernels over contiguous arrays of arithmetic values, using the widest vector instructions
+    // that the processor supports, as detected at run time.
+
+#pragma region Instruction sets
+
+    enum class InstructionSet
+    {
+        scalar,
+        avx2,
+        avx512
+    };
+
+    namespace details
+    {
+        inline InstructionSet detect_instruction_set()
+        {
+#if defined(FORWARD_X64) && defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 1);
+            bool os_saves_ymm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 0x6) == 0x6);
+            if (!os_saves_ymm)
+                return InstructionSet::scalar;
+
+            __cpuidex(info, 7, 0);
+            bool os_saves_zmm = (_xgetbv(0) & 0xe6) == 0xe6;
+            if ((info[1] & (1 << 16)) && os_saves_zmm)
+                return InstructionSet::avx512;
+            if (info[1] & (1 << 5))
+                return InstructionSet::avx2;
+            return InstructionSet::scalar;
+#elif defined(FORWARD_X64)
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f"))
+                return InstructionSet::avx512;
+            if (__builtin_cpu_supports("avx2"))
+                return InstructionSet::avx2;
+            return InstructionSet::scalar;
+#else
+            return InstructionSet::scalar;
+#endif
+        }
+    }
+
+    // The widest instruction set supported by the processor, detected once
+    inline InstructionSet instruction_set()
+    {
+        static const InstructionSet detected = details::detect_instruction_set();
+        return detected;
+    }
+
+#pragma endregion
+
+#pragma region Sum
+
+    namespace details
+    {
+        // Four independent accumulators, so that the additions do not wait for each other
+        template <typename T>
+        T sum_scalar(const T* data, size_t size)
+        {
+            T a = 0, b = 0, c = 0, d = 0;
+            size_t i = 0;
+            for (; i + 4 <= size; i += 4)
+            {
+                a += data[i];
+                b += data[i + 1];
+                c += data[i + 2];
+                d += data[i + 3];
+            }
+            for (; i < size; ++i)
+                a += data[i];
+            return static_cast<T>((a + b) + (c + d));
+        }
+
+#ifdef FORWARD_X64
+
+        FORWARD_TARGET_AVX2 inline float sum_avx2(const float* data, size_t size)
+        {
+            __m256 a = _mm256_setzero_ps(), b = a, c = a, d = a;
+            size_t i = 0;
+            for (; i + 32 <= size; i += 32)
+            {
+                a = _mm256_add_ps(a, _mm256_loadu_ps(data + i));
+                b = _mm256_add_ps(b, _mm256_loadu_ps(data + i + 8));
+                c = _mm256_add_ps(c, _mm256_loadu_ps(data + i + 16));
+                d = _mm256_add_ps(d, _mm256_loadu_ps(data + i + 24));
+            }
+            __m256 all = _mm256_add_ps(_mm256_add_ps(a, b), _mm256_add_ps(c, d));
+            __m128 half = _mm_add_ps(_mm256_castps256_ps128(all), _mm256_extractf128_ps(all, 1));
+            half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+            half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+            return _mm_cvtss_f32(half) + sum_scalar(data + i, size - i);
+        }
+
+        FORWARD_TARGET_AVX2 inline double sum_avx2(const double* data, size_t size)
+        {
+            __m256d a = _mm256_setzero_pd(), b = a, c = a, d = a;
+            size_t i = 0;
+            for (; i + 16 <= size; i += 16)
+            {
+                a = _mm256_add_pd(a, _mm256_loadu_pd(data + i));
+                b = _mm256_add_pd(b, _mm256_loadu_pd(data + i + 4));
+                c = _mm256_add_pd(c, _mm256_loadu_pd(data + i + 8));
+                d = _mm256_add_pd(d, _mm256_loadu_pd(data + i + 12));
+            }
+            __m256d all = _mm256_add_pd(_mm256_add_pd(a, b), _mm256_add_pd(c, d));
+            __m128d half = _mm_add_pd(_mm256_castpd256_pd128(all), _mm256_extractf128_pd(all, 1));
+            half = _mm_add_sd(half, _mm_unpackhi_pd(half, half));
+            return _mm_cvtsd_f64(half) + sum_scalar(data + i, size - i);
+        }
+
+        // Adds lanes of integers of 32 or 64 bits, which wrap around identically whether signed or not
+        template <typename T>
+        FORWARD_TARGET_AVX2 __m256i add_avx2(__m256i x, __m256i y)
+        {
+            if constexpr (sizeof(T) == 4)
+                return _mm256_add_epi32(x, y);
+            else
+                return _mm256_add_epi64(x, y);
+        }
+
+        template <typename T>
+        FORWARD_TARGET_AVX2 T sum_integers_avx2(const T* data, size_t size)
+        {
+            constexpr size_t lanes = 32 / sizeof(T);
+            __m256i a = _mm256_setzero_si256(), b = a, c = a, d = a;
+            size_t i = 0;
+            for (; i + 4 * lanes <= size; i += 4 * lanes)
+            {
+                a = add_avx2<T>(a, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)));
+                b = add_avx2<T>(b, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + lanes)));
+                c = add_avx2<T>(c, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 2 * lanes)));
+                d = add_avx2<T>(d, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 3 * lanes)));
+            }
+            alignas(32) T partial[lanes];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(partial), add_avx2<T>(add_avx2<T>(a, b), add_avx2<T>(c, d)));
+
+            using U = std::make_unsigned_t<T>;
+            U result = 0;
+            for (size_t lane = 0; lane < lanes; ++lane)
+                result += static_cast<U>(partial[lane]);
+            for (; i < size; ++i)
+                result += static_cast<U>(data[i]);
+            return static_cast<T>(result);
+        }
+
+        FORWARD_TARGET_AVX512 inline float sum_avx512(const float* data, size_t size)
+        {
+            __m512 a = _mm512_setzero_ps(), b = a, c = a, d = a;
+            size_t i = 0;
+            for (; i + 64 <= size; i += 64)
+            {
+                a = _mm512_add_ps(a, _mm512_loadu_ps(data + i));
+                b = _mm512_add_ps(b, _mm512_loadu_ps(data + i + 16));
+                c = _mm512_add_ps(c, _mm512_loadu_ps(data + i + 32));
+                d = _mm512_add_ps(d, _mm512_loadu_ps(data + i + 48));
+            }
+            return _mm512_reduce_add_ps(_mm512_add_ps(_mm512_add_ps(a, b), _mm512_add_ps(c, d)))
+                + sum_scalar(data + i, size - i);
+        }
+
+        FORWARD_TARGET_AVX512 inline double sum_avx512(const double* data, size_t size)
+        {
+            __m512d a = _mm512_setzero_pd(), b = a, c = a, d = a;
+            size_t i = 0;
+            for (; i + 32 <= size; i += 32)
+            {
+                a = _mm512_add_pd(a, _mm512_loadu_pd(data + i));
+                b = _mm512_add_pd(b, _mm512_loadu_pd(data + i + 8));
+                c = _mm512_add_pd(c, _mm512_loadu_pd(data + i + 16));
+                d = _mm512_add_pd(d, _mm512_loadu_pd(data + i + 24));
+            }
+            return _mm512_reduce_add_pd(_mm512_add_pd(_mm512_add_pd(a, b), _mm512_add_pd(c, d)))
+                + sum_scalar(data + i, size - i);
+        }
+
+        template <typename T>
+        FORWARD_TARGET_AVX512 __m512i add_avx512(__m512i x, __m512i y)
+        {
+            if constexpr (sizeof(T) == 4)
+                return _mm512_add_epi32(x, y);
+            else
+                return _mm512_add_epi64(x, y);
+        }
+
+        template <typename T>
+        FORWARD_TARGET_AVX512 T sum_integers_avx512(const T* data, size_t size)
+        {
+            constexpr size_t lanes = 64 / sizeof(T);
+            __m512i a = _mm512_setzero_si512(), b = a, c = a, d = a;
+            size_t i = 0;
+            for (; i + 4 * lanes <= size; i += 4 * lanes)
+            {
+                a = add_avx512<T>(a, _mm512_loadu_si512(data + i));
+                b = add_avx512<T>(b, _mm512_loadu_si512(data + i + lanes));
+                c = add_avx512<T>(c, _mm512_loadu_si512(data + i + 2 * lanes));
+                d = add_avx512<T>(d, _mm512_loadu_si512(data + i + 3 * lanes));
+            }
+            alignas(64) T partial[lanes];
+            _mm512_store_si512(partial, add_avx512<T>(add_avx512<T>(a, b), add_avx512<T>(c, d)));
+
+            using U = std::make_unsigned_t<T>;
+            U result = 0;
+            for (size_t lane = 0; lane < lanes; ++lane)
+                result += static_cast<U>(partial[lane]);
+            for (; i < size; ++i)
+                result += static_cast<U>(data[i]);
+            return static_cast<T>(result);
+        }
+
+#endif
+    }
+
+    // Whether sum_array has vectorized kernels for the type
+    template <typename T>
+    constexpr bool has_sum_kernel =
+        std::is_same_v<T, float> || std::is_same_v<T, double> ||
+        (std::is_integral_v<T> && !std::is_same_v<T, bool> && (sizeof(T) == 4 || sizeof(T) == 8));
+
+    // The sum of an array of arithmetic values.
+    // Floating point values are added in a different order than one after the other,
+    // which may change the rounding of the result.
+    template <typename T>
+    T sum_array(const T* data, size_t size)
+    {
+#ifdef FORWARD_X64
+        if constexpr (has_sum_kernel<T>)
+        {
+            auto set = instruction_set();
+
+            if constexpr (std::is_floating_point_v<T>)
+            {
+                if (set == InstructionSet::avx512)
+                    return details::sum_avx512(data, size);
+                if (set == InstructionSet::avx2)
+                    return details::sum_avx2(data, size);
+            }
+            else
+            {
+                if (set == InstructionSet::avx512)
+                    return details::sum_integers_avx512(data, size);
+                if (set == InstructionSet::avx2)
+                    return details::sum_integers_avx2(data, size);
+            }
+        }
+#endif
+        return details::sum_scalar(data, size);
+    }
+
+#pragma endregion
+}
@@ -1,45 +1,67 @@
 #pragma once
 
 #include "forward-basics.h"
+#include "forward-hash.h"
+#include "forward-io.h"
+#include "forward-parallel.h"
 
 #include <unordered_set>
 #include <unordered_map>
 #include <algorithm>
 #include <random>
+#include <array>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <memory>
 
 namespace forward
 {
     // CONTAINS:
-    // to_unordered_set, distinct
-    // to_ordered_vector, orderby
-    // 
-    // TODO:
-    // revert
-    //
-    // permutate_randomly
-    // lines of a text file, files of a directory
+    // to_set, to_unordered_set, distinct
+    // to_ordered_vector, orderby (radix sort on arithmetic keys and tuples of them), top_k, assume_ordered_by
+    // shuffle, sample, reverse
+    // to_groups, group_by, aggregate_count, aggregate_sum, aggregate_max, aggregate_min
+    // join, where_in, where_not_in, merge_join
 
 #pragma region ToSet, Distinct
 
+    namespace details
+    {
+        template <typename Set, typename Enumerable>
+        void insert_all(Set& set, const Enumerable& enumerable)
+        {
+            for_each(enumerable, [&](auto&& value)
+            {
+                set.insert(std::forward<decltype(value)>(value));
+            });
+        }
+    }
+
+    // The distinct elements, in a FlatHashSet.
+    // The size hint only bounds the number of distinct elements: the table grows instead, since a table 
+    // much larger than its content costs more in cache misses than moving the elements when growing.
     template <typename Enumerable>
     auto to_set(const Enumerable& enumerable)
     {
         static_assert(Enumerable::is_enumerable, "Oops.");
-        auto enumerator = enumerable.get_enumerator();
+        using stored_type = enumerated_type<decltype(enumerable.get_enumerator())>;
 
-        using actual_type = decltype(std::get<1>(enumerator.next()));
-        using stored_type = std::remove_reference<actual_type>::type;
+        FlatHashSet<stored_type> result;
+        details::insert_all(result, enumerable);
+        return result;
+    }
 
-        std::unordered_set<stored_type> result;
+    template <typename Enumerable>
+    auto to_unordered_set(const Enumerable& enumerable)
+    {
+        static_assert(Enumerable::is_enumerable, "Oops.");
+        using stored_type = enumerated_type<decltype(enumerable.get_enumerator())>;
 
-        for (;;)
-        {
-            auto&& next = enumerator.next();
-            if (!has_more(next))
-                break;
-            result.insert(std::forward<actual_type>(std::get<1>(next)));
-        }
+        std::unordered_set<stored_type> result;
+        result.reserve(reserved_size(get_size_hint(enumerable)));
 
+        details::insert_all(result, enumerable);
         return result;
     }
 
@@ -49,14 +71,14 @@ namespace forward
     public:
 
         template <typename Enumerable>
-        std::unordered_set<T> apply(const Enumerable& enumerable) const
+        FlatHashSet<T> apply(const Enumerable& enumerable) const
         {
             return to_set(enumerable);
         }
     };
 
     template <typename Enumerable, typename T>
-    std::unordered_set<T> operator >> (const Enumerable& enumerable, const ToSet<T>& fold)
+    FlatHashSet<T> operator >> (const Enumerable& enumerable, const ToSet<T>& fold)
     {
         return fold.apply(enumerable);
     }
@@ -69,23 +91,136 @@ namespace forward
 
 
     template <typename T>
-    class Distinct
+    class ToUnorderedSet
     {
     public:
 
         template <typename Enumerable>
-        auto apply(const Enumerable& enumerable) const
+        std::unordered_set<T> apply(const Enumerable& enumerable) const
         {
-            return from_moved(to_set(enumerable));
+            return to_unordered_set(enumerable);
         }
     };
 
     template <typename Enumerable, typename T>
-    auto operator >> (const Enumerable& enumerable, Distinct<T> fold)
+    std::unordered_set<T> operator >> (const Enumerable& enumerable, const ToUnorderedSet<T>& fold)
     {
         return fold.apply(enumerable);
     }
 
+    template <typename T>
+    ToUnorderedSet<T> to_unordered_set()
+    {
+        return ToUnorderedSet<T>();
+    }
+
+
+    // Reserving the whole hint of a long input would make a table much larger than the distinct elements,
+    // so the seen sets start from at most that many slots and grow from there
+    const size_t distinct_reserve_limit = 1 << 16;
+
+    template <typename Enumerator>
+    class DistinctEnumerator
+    {
+    public:
+
+        static const bool is_enumerator = true;
+        using stored_type = enumerated_type<Enumerator>;
+
+        DistinctEnumerator(Enumerator enumerator, size_t reserved) :
+            _enumerator(std::move(enumerator))
+        {
+            _seen.reserve(reserved);
+        }
+
+        auto next()
+        {
+            // The first occurrences are passed through, without being re-wrapped
+            for (;;)
+            {
+                auto current = _enumerator.next();
+
+                if (!has_more(current))
+                    return current;
+
+                if (_seen.insert(get_value_by_ref(current)).second)
+                    return current;
+            }
+        }
+
+    private:
+
+        Enumerator _enumerator;
+        FlatHashSet<stored_type> _seen;
+    };
+
+    // The first occurrence of every element, in the order of the input.
+    // Elements are yielded as soon as they are pulled, and only the distinct ones are kept.
+    template <typename Enumerable>
+    class DistinctEnumerable
+    {
+    public:
+
+        static const bool is_enumerable = true;
+        using enumerator = DistinctEnumerator<typename Enumerable::enumerator>;
+
+        DistinctEnumerable(Enumerable enumerable) :
+            _enumerable(std::move(enumerable))
+        {
+        }
+
+        enumerator get_enumerator() const
+        {
+            return enumerator(_enumerable.get_enumerator(), reserved());
+        }
+
+        template <typename Sink>
+        void push_to(Sink& sink) const
+        {
+            FlatHashSet<typename enumerator::stored_type> seen;
+            seen.reserve(reserved());
+
+            for_each(_enumerable, [&](auto&& value)
+            {
+                if (seen.insert(std::as_const(value)).second)
+                    sink(std::forward<decltype(value)>(value));
+            });
+        }
+
+        std::optional<SizeHint> size_hint() const
+        {
+            return at_most(get_size_hint(_enumerable));
+        }
+
+    private:
+
+        size_t reserved() const
+        {
+            auto hint = get_size_hint(_enumerable);
+            return hint ? std::min(hint->size, distinct_reserve_limit) : 0;
+        }
+
+        Enumerable _enumerable;
+    };
+
+    template <typename T>
+    class Distinct
+    {
+    public:
+
+        template <typename Enumerable>
+        DistinctEnumerable<std::decay_t<Enumerable>> apply(Enumerable&& enumerable) const
+        {
+            return DistinctEnumerable<std::decay_t<Enumerable>>(std::forward<Enumerable>(enumerable));
+        }
+    };
+
+    template <typename Enumerable, typename T>
+    auto operator >> (Enumerable&& enumerable, Distinct<T> fold)
+    {
+        return fold.apply(std::forward<Enumerable>(enumerable));
+    }
+
     template <typename T>
     auto distinct()
     {
@@ -94,18 +229,221 @@ namespace forward
 
 #pragma endregion
 
+#pragma region Radix sort
+
+    namespace details
+    {
+        // Maps keys to unsigned integers of the same width, in the same order
+        template <typename Key, typename = void>
+        struct radix_key {};
+
+        template <typename Key>
+        struct radix_key<Key, std::enable_if_t<std::is_integral_v<Key> && !std::is_same_v<Key, bool>>>
+        {
+            using type = std::make_unsigned_t<Key>;
+
+            static type encode(Key key)
+            {
+                if constexpr (std::is_signed_v<Key>)
+                    return static_cast<type>(key) ^ (type(1) << (8 * sizeof(type) - 1));
+                else
+                    return key;
+            }
+        };
+
+        // Positive floating point values are ordered like their bits, and negative ones in reverse
+        template <typename Key>
+        struct radix_key<Key, std::enable_if_t<std::is_floating_point_v<Key> && (sizeof(Key) == 4 || sizeof(Key) == 8)>>
+        {
+            using type = std::conditional_t<sizeof(Key) == 4, std::uint32_t, std::uint64_t>;
+
+            static type encode(Key key)
+            {
+                if (key == 0)
+                    key = 0; // -0 and +0 compare equal
+
+                type bits;
+                std::memcpy(&bits, &key, sizeof(bits));
+                const type sign = type(1) << (8 * sizeof(type) - 1);
+                return (bits & sign) ? ~bits : bits | sign;
+            }
+        };
+
+        template <typename Key, typename = void>
+        struct has_radix_key : std::false_type {};
+
+        template <typename Key>
+        struct has_radix_key<Key, std::void_t<typename radix_key<Key>::type>> : std::true_type {};
+
+        // Scalars with a radix key, and tuples and pairs of them. Nested tuples and pairs are sorted by comparisons.
+        template <typename Key>
+        struct is_radix_sortable : has_radix_key<Key> {};
+
+        template <typename... Keys>
+        struct is_radix_sortable<std::tuple<Keys...>> : std::bool_constant<(has_radix_key<Keys>::value && ...)> {};
+
+        template <typename First, typename Second>
+        struct is_radix_sortable<std::pair<First, Second>> : std::bool_constant<
+            has_radix_key<First>::value && has_radix_key<Second>::value> {};
+
+        // Stable counting sorts on every byte of a component of the keys, from the least significant one.
+        // The counts of all the bytes are taken in a single read of the keys, and bytes on which all 
+        // the keys agree are skipped.
+        template <typename Keyed, typename ComponentOf>
+        void radix_passes(std::vector<Keyed>& keyed, std::vector<Keyed>& buffer, const ComponentOf& component_of)
+        {
+            using component_type = std::decay_t<decltype(component_of(keyed[0]))>;
+            using traits = radix_key<component_type>;
+            constexpr size_t bytes = sizeof(typename traits::type);
+
+            std::vector<std::array<size_t, 256>> counts(bytes);
+            for (const auto& k : keyed)
+            {
+                auto encoded = traits::encode(component_of(k));
+                for (size_t byte = 0; byte < bytes; ++byte)
+                    ++counts[byte][static_cast<size_t>(encoded >> (8 * byte)) & 0xff];
+            }
+
+            for (size_t byte = 0; byte < bytes; ++byte)
+            {
+                auto& offsets = counts[byte];
+                if (std::find(offsets.begin(), offsets.end(), keyed.size()) != offsets.end())
+                    continue;
+
+                size_t offset = 0;
+                for (auto& count : offsets)
+                {
+                    auto current = count;
+                    count = offset;
+                    offset += current;
+                }
+
+                for (auto& k : keyed)
+                    buffer[offsets[static_cast<size_t>(traits::encode(component_of(k)) >> (8 * byte)) & 0xff]++] = std::move(k);
+
+                keyed.swap(buffer);
+            }
+        }
+
+        template <size_t Index, typename Keyed, typename KeyOf>
+        void radix_passes_from_component(std::vector<Keyed>& keyed, std::vector<Keyed>& buffer, const KeyOf& key_of)
+        {
+            radix_passes(keyed, buffer, [&](const Keyed& k) { return std::get<Index>(key_of(k)); });
+            if constexpr (Index > 0)
+                radix_passes_from_component<Index - 1>(keyed, buffer, key_of);
+        }
+
+        // LSD radix sort of (key, index) pairs, on keys that are integers, floating point values, 
+        // or tuples and pairs of them. Tuples are sorted on their last component first. The sort is stable.
+        template <typename Keyed, typename KeyOf>
+        void radix_sort_keyed(std::vector<Keyed>& keyed, const KeyOf& key_of)
+        {
+            using key_type = std::decay_t<decltype(key_of(keyed[0]))>;
+
+            if (keyed.size() < 2)
+                return;
+
+            std::vector<Keyed> buffer(keyed.size());
+            if constexpr (std::is_arithmetic_v<key_type>)
+                radix_passes(keyed, buffer, key_of);
+            else
+                radix_passes_from_component<std::tuple_size<key_type>::value - 1>(keyed, buffer, key_of);
+        }
+    }
+
+#pragma endregion
+
 #pragma region Order
 
+    namespace details
+    {
+        template <typename T>
+        constexpr bool is_scalar_key = std::is_arithmetic_v<T> || std::is_pointer_v<T>;
+
+        // Whether sorting values of this type by keys of that type evaluates the keys inside the comparisons.
+        // Only scalar keys of scalar values are assumed to be cheap; any other key, such as a string looked up 
+        // from an int, is evaluated once per element. Keys that can be radix sorted are always evaluated once per element.
+        template <typename T, typename Key>
+        constexpr bool compares_keys_directly = is_scalar_key<T> && is_scalar_key<Key>;
+
+        // Sorts (key, index) pairs by key, and by index between equal keys
+        template <typename Keyed, typename KeyOf>
+        void sort_keyed(std::vector<Keyed>& keyed, const KeyOf& key_of)
+        {
+            std::sort(keyed.begin(), keyed.end(), [&](const Keyed& a, const Keyed& b)
+            {
+                if (key_of(a) < key_of(b))
+                    return true;
+                if (key_of(b) < key_of(a))
+                    return false;
+                return a.second < b.second;
+            });
+        }
+
+        // Evaluates the key of every value once into a (key, index) array, sorts that array,
+        // with a radix sort when the keys allow it, and then moves the values in that order. 
+        // Keys returned by reference into the value are not copied. The sort is stable.
+        template <typename T, typename Evaluation>
+        void sort_by_cached_keys(std::vector<T>& values, const Evaluation& evaluation)
+        {
+            using result_type = decltype(evaluation(std::declval<const T&>()));
+            using key_type = std::decay_t<result_type>;
+            constexpr bool by_reference = std::is_lvalue_reference_v<result_type>;
+            using cached_type = std::conditional_t<by_reference, const key_type*, key_type>;
+            using keyed_type = std::pair<cached_type, size_t>;
+
+            auto key_of = [](const keyed_type& keyed) -> const key_type&
+            {
+                if constexpr (by_reference)
+                    return *keyed.first;
+                else
+                    return keyed.first;
+            };
+
+            std::vector<keyed_type> keyed;
+            keyed.reserve(values.size());
+            for (size_t i = 0; i < values.size(); ++i)
+            {
+                if constexpr (by_reference)
+                    keyed.emplace_back(&evaluation(values[i]), i);
+                else
+                    keyed.emplace_back(evaluation(values[i]), i);
+            }
+
+            if constexpr (is_radix_sortable<key_type>::value)
+                radix_sort_keyed(keyed, key_of);
+            else
+                sort_keyed(keyed, key_of);
+
+            // Gathering the values in their new order reads them at random but writes them in sequence,
+            // which is much faster than following the cycles of the permutation in place
+            std::vector<T> sorted;
+            sorted.reserve(values.size());
+            for (const auto& k : keyed)
+                sorted.push_back(std::move(values[k.second]));
+            values.swap(sorted);
+        }
+    }
+
     template <typename Enumerable, typename Evaluation>
     auto to_vector_ordered_by(const Enumerable& enumerable, const Evaluation& evaluation)
     {
         static_assert(Enumerable::is_enumerable, "Oops.");
         auto result = to_vector(enumerable);
+        using value_type = typename decltype(result)::value_type;
+        using key_type = std::decay_t<decltype(evaluation(std::declval<const value_type&>()))>;
 
-        std::sort(result.begin(), result.end(), [&](const auto& a, const auto& b)
+        if constexpr (details::compares_keys_directly<value_type, key_type> && !details::is_radix_sortable<key_type>::value)
         {
-            return evaluation(a) < evaluation(b);
-        });
+            std::sort(result.begin(), result.end(), [&](const auto& a, const auto& b)
+            {
+                return evaluation(a) < evaluation(b);
+            });
+        }
+        else
+        {
+            details::sort_by_cached_keys(result, evaluation);
+        }
 
         return result;
     }
@@ -143,6 +481,75 @@ namespace forward
     }
 
 
+    // An enumerable whose elements are known to come in ascending order of a key: the result of order_by,
+    // or any enumerable after assume_ordered_by. It enumerates exactly like the underlying enumerable, 
+    // and carries the key for the stages that rely on the order, like merge_join, so that nothing is sorted again.
+    template <typename Enumerable, typename Evaluation>
+    class OrderedEnumerable
+    {
+    public:
+
+        static const bool is_enumerable = true;
+        using enumerator = typename Enumerable::enumerator;
+
+        OrderedEnumerable(Enumerable enumerable, Evaluation evaluation) :
+            _enumerable(std::move(enumerable)),
+            _evaluation(std::move(evaluation))
+        {
+        }
+
+        enumerator get_enumerator() const
+        {
+            return _enumerable.get_enumerator();
+        }
+
+        template <typename E = Enumerable>
+        auto get_reverse_enumerator() const -> decltype(std::declval<const E&>().get_reverse_enumerator())
+        {
+            return _enumerable.get_reverse_enumerator();
+        }
+
+        template <typename Sink>
+        void push_to(Sink& sink) const
+        {
+            for_each(_enumerable, sink);
+        }
+
+        template <typename E = Enumerable>
+        auto source_size() const -> decltype(std::declval<const E&>().source_size())
+        {
+            return _enumerable.source_size();
+        }
+
+        template <typename Sink>
+        void push_range(size_t first, size_t last, Sink& sink) const
+        {
+            _enumerable.push_range(first, last, sink);
+        }
+
+        template <typename E = Enumerable>
+        auto iteratable() const -> decltype(std::declval<const E&>().iteratable())
+        {
+            return _enumerable.iteratable();
+        }
+
+        std::optional<SizeHint> size_hint() const
+        {
+            return get_size_hint(_enumerable);
+        }
+
+        // The key of the order
+        const Evaluation& ordered_key() const
+        {
+            return _evaluation;
+        }
+
+    private:
+
+        Enumerable _enumerable;
+        Evaluation _evaluation;
+    };
+
     template <typename T, typename Evaluation>
     class OrderedBy
     {
@@ -153,9 +560,10 @@ namespace forward
         {}
 
         template <typename Enumerable>
-        auto apply(const Enumerable& enumerable) const
+        auto apply(const Enumerable& enumerable) &&
         {
-            return from_moved(to_vector_ordered_by(enumerable, _evaluation));
+            auto sorted = from_moved(to_vector_ordered_by(enumerable, _evaluation));
+            return OrderedEnumerable<decltype(sorted), Evaluation>(std::move(sorted), std::move(_evaluation));
         }
 
     private:
@@ -166,7 +574,7 @@ namespace forward
     template <typename Enumerable, typename T, typename Evaluation>
     auto operator >> (const Enumerable& enumerable, OrderedBy<T, Evaluation> fold)
     {
-        return fold.apply(enumerable);
+        return std::move(fold).apply(enumerable);
     }
 
     template <typename T, typename Evaluation>
@@ -175,5 +583,1423 @@ namespace forward
         return OrderedBy<T, Evaluation>(std::move(evaluation));
     }
 
+
+    // Declares that an enumerable already comes in ascending order of the key, such as a time-ordered log, without sorting it.
+    // Nothing checks the order: stages that rely on it are only correct when it holds.
+    template <typename T, typename Evaluation>
+    class AssumeOrderedBy
+    {
+    public:
+
+        AssumeOrderedBy(Evaluation evaluation) :
+            _evaluation(std::move(evaluation))
+        {}
+
+        template <typename Enumerable>
+        OrderedEnumerable<std::decay_t<Enumerable>, Evaluation> apply(Enumerable&& enumerable) &&
+        {
+            return { std::forward<Enumerable>(enumerable), std::move(_evaluation) };
+        }
+
+    private:
+
+        Evaluation _evaluation;
+    };
+
+    template <typename Enumerable, typename T, typename Evaluation>
+    auto operator >> (Enumerable&& enumerable, AssumeOrderedBy<T, Evaluation> assumption)
+    {
+        return std::move(assumption).apply(std::forward<Enumerable>(enumerable));
+    }
+
+    template <typename T, typename Evaluation>
+    AssumeOrderedBy<T, Evaluation> assume_ordered_by(Evaluation evaluation)
+    {
+        return AssumeOrderedBy<T, Evaluation>(std::move(evaluation));
+    }
+
+
+    // The k first elements of the enumerable ordered by the key, in that order, as from order_by followed by take.
+    // Streams the enumerable through a max-heap of the k best elements so far, evaluating every key once:
+    // O(n log k) time, and memory for k elements only. Equal keys keep the order of the enumerable.
+    template <typename Enumerable, typename Evaluation>
+    auto top_k(const Enumerable& enumerable, size_t k, const Evaluation& evaluation)
+    {
+        static_assert(Enumerable::is_enumerable, "Oops.");
+        using stored_type = enumerated_type<decltype(enumerable.get_enumerator())>;
+        using key_type = std::decay_t<decltype(evaluation(std::declval<const stored_type&>()))>;
+
+        struct Entry
+        {
+            key_type key;
+            size_t sequence;
+            size_t slot;
+        };
+
+        auto before = [](const Entry& a, const Entry& b)
+        {
+            if (a.key < b.key)
+                return true;
+            if (b.key < a.key)
+                return false;
+            return a.sequence < b.sequence;
+        };
+
+        // Without a hint, k can be far larger than the enumerable, and the vectors grow with the elements instead
+        size_t reserved = 0;
+        if (auto hint = get_size_hint(enumerable))
+            reserved = std::min(k, hint->size);
+
+        std::vector<Entry> heap;
+        std::vector<stored_type> values;
+        heap.reserve(reserved);
+        values.reserve(reserved);
+
+        size_t sequence = 0;
+        if (k != 0)
+        {
+            for_each(enumerable, [&](auto&& value)
+            {
+                if (heap.size() < k)
+                {
+                    heap.push_back(Entry{ evaluation(std::as_const(value)), sequence, values.size() });
+                    values.push_back(std::forward<decltype(value)>(value));
+                    std::push_heap(heap.begin(), heap.end(), before);
+                }
+                else
+                {
+                    // Later elements never displace earlier ones of equal keys
+                    key_type key = evaluation(std::as_const(value));
+                    if (key < heap.front().key)
+                    {
+                        std::pop_heap(heap.begin(), heap.end(), before);
+                        auto& entry = heap.back();
+                        entry.key = std::move(key);
+                        entry.sequence = sequence;
+                        values[entry.slot] = std::forward<decltype(value)>(value);
+                        std::push_heap(heap.begin(), heap.end(), before);
+                    }
+                }
+                ++sequence;
+            });
+        }
+
+        std::sort_heap(heap.begin(), heap.end(), before);
+
+        std::vector<stored_type> result;
+        result.reserve(heap.size());
+        for (const auto& entry : heap)
+            result.push_back(std::move(values[entry.slot]));
+
+        return result;
+    }
+
+    template <typename T, typename Evaluation>
+    class TopK
+    {
+    public:
+
+        TopK(size_t k, Evaluation evaluation) :
+            _k(k),
+            _evaluation(std::move(evaluation))
+        {}
+
+        template <typename Enumerable>
+        std::vector<T> apply(const Enumerable& enumerable) const
+        {
+            return top_k(enumerable, _k, _evaluation);
+        }
+
+    private:
+
+        size_t _k;
+        Evaluation _evaluation;
+    };
+
+    template <typename Enumerable, typename T, typename Evaluation>
+    std::vector<T> operator >> (const Enumerable& enumerable, const TopK<T, Evaluation>& fold)
+    {
+        return fold.apply(enumerable);
+    }
+
+    template <typename T, typename Evaluation>
+    TopK<T, Evaluation> top_k(size_t k, Evaluation evaluation)
+    {
+        return TopK<T, Evaluation>(k, std::move(evaluation));
+    }
+
+#pragma endregion
+
+#pragma region Reverse
+
+    // An enumerator over values that it owns, from the last one to the first one
+    template <typename T>
+    class BufferedReverseEnumerator
+    {
+    public:
+
+        static const bool is_enumerator = true;
+
+        BufferedReverseEnumerator(std::vector<T> values) :
+            _values(std::move(values)),
+            _remaining(_values.size())
+        {}
+
+        auto next()
+        {
+            if (_remaining == 0)
+                return yield_none<T>();
+            return yield_some(std::move(_values[--_remaining]));
+        }
+
+        size_t next_batch(T* buffer, size_t capacity)
+        {
+            size_t count = std::min(capacity, _remaining);
+            for (size_t i = 0; i < count; ++i)
+                buffer[i] = std::move(_values[--_remaining]);
+            return count;
+        }
+
+        void skip(size_t count)
+        {
+            _remaining -= std::min(count, _remaining);
+        }
+
+    private:
+
+        std::vector<T> _values;
+        size_t _remaining;
+    };
+
+    namespace details
+    {
+        template <typename Enumerable>
+        auto make_reverse_enumerator(const Enumerable& enumerable)
+        {
+            if constexpr (has_reverse_enumerator<Enumerable>::value)
+                return enumerable.get_reverse_enumerator();
+            else
+                return BufferedReverseEnumerator<enumerated_type<typename Enumerable::enumerator>>(to_vector(enumerable));
+        }
+    }
+
+    // The elements of the enumerable, from the last one to the first one.
+    // Integral ranges, bidirectional iteratables, and where and select over them are enumerated backwards in place,
+    // with nothing allocated. Other enumerables are collected once per enumeration, when the enumerator is created.
+    template <typename Enumerable>
+    class ReverseEnumerable
+    {
+    public:
+
+        static const bool is_enumerable = true;
+        using enumerator = decltype(details::make_reverse_enumerator(std::declval<const Enumerable&>()));
+
+        ReverseEnumerable(Enumerable enumerable) :
+            _enumerable(std::move(enumerable))
+        {
+        }
+
+        enumerator get_enumerator() const
+        {
+            return details::make_reverse_enumerator(_enumerable);
+        }
+
+        // Reversing twice gives back the original order, without buffering
+        typename Enumerable::enumerator get_reverse_enumerator() const
+        {
+            return _enumerable.get_enumerator();
+        }
+
+        std::optional<SizeHint> size_hint() const
+        {
+            return get_size_hint(_enumerable);
+        }
+
+    private:
+
+        Enumerable _enumerable;
+    };
+
+    class Reverse
+    {
+    public:
+
+        template <typename Enumerable>
+        ReverseEnumerable<std::decay_t<Enumerable>> apply(Enumerable&& enumerable) const
+        {
+            return ReverseEnumerable<std::decay_t<Enumerable>>(std::forward<Enumerable>(enumerable));
+        }
+    };
+
+    template <typename Enumerable>
+    ReverseEnumerable<std::decay_t<Enumerable>> operator >> (Enumerable&& enumerable, const Reverse& reverse)
+    {
+        return reverse.apply(std::forward<Enumerable>(enumerable));
+    }
+
+    inline Reverse reverse()
+    {
+        return Reverse();
+    }
+
+#pragma endregion
+
+#pragma region Random
+
+    // An enumerator over values that it owns, in a random order.
+    // Every call to next() draws the next value among those not returned yet (a Fisher-Yates shuffle, 
+    // one step at a time), so that taking k values costs k steps.
+    template <typename T>
+    class ShuffleEnumerator
+    {
+    public:
+
+        static const bool is_enumerator = true;
+
+        ShuffleEnumerator(std::vector<T> values, std::uint64_t seed) :
+            _values(std::move(values)),
+            _position(0),
+            _generator(seed)
+        {}
+
+        auto next()
+        {
+            if (_position == _values.size())
+                return yield_none<T>();
+
+            std::uniform_int_distribution<size_t> distribution(_position, _values.size() - 1);
+            size_t drawn = distribution(_generator);
+            if (drawn != _position)
+                std::swap(_values[_position], _values[drawn]);
+
+            return yield_some(std::move(_values[_position++]));
+        }
+
+    private:
+
+        std::vector<T> _values;
+        size_t _position;
+        std::mt19937_64 _generator;
+    };
+
+    // The elements of the enumerable in a random order, which only depends on the seed.
+    // The elements are collected once per enumeration, when the enumerator is created.
+    template <typename Enumerable>
+    class ShuffleEnumerable
+    {
+    public:
+
+        static const bool is_enumerable = true;
+        using enumerator = ShuffleEnumerator<enumerated_type<typename Enumerable::enumerator>>;
+
+        ShuffleEnumerable(Enumerable enumerable, std::uint64_t seed) :
+            _enumerable(std::move(enumerable)),
+            _seed(seed)
+        {
+        }
+
+        enumerator get_enumerator() const
+        {
+            return enumerator(to_vector(_enumerable), _seed);
+        }
+
+        std::optional<SizeHint> size_hint() const
+        {
+            return get_size_hint(_enumerable);
+        }
+
+    private:
+
+        Enumerable _enumerable;
+        std::uint64_t _seed;
+    };
+
+    class Shuffle
+    {
+    public:
+
+        Shuffle(std::uint64_t seed) :
+            _seed(seed)
+        {}
+
+        template <typename Enumerable>
+        ShuffleEnumerable<std::decay_t<Enumerable>> apply(Enumerable&& enumerable) const
+        {
+            return ShuffleEnumerable<std::decay_t<Enumerable>>(std::forward<Enumerable>(enumerable), _seed);
+        }
+
+    private:
+
+        std::uint64_t _seed;
+    };
+
+    template <typename Enumerable>
+    ShuffleEnumerable<std::decay_t<Enumerable>> operator >> (Enumerable&& enumerable, const Shuffle& shuffle)
+    {
+        return shuffle.apply(std::forward<Enumerable>(enumerable));
+    }
+
+    inline Shuffle shuffle(std::uint64_t seed)
+    {
+        return Shuffle(seed);
+    }
+
+
+    // k elements drawn uniformly from the enumerable, in no particular order, or all of them if there are fewer.
+    // Reservoir sampling in a single pass, with Algorithm L: after the first k elements, the number of elements 
+    // to skip before the next one enters the reservoir is drawn directly, so that only O(k log(n/k)) elements 
+    // are produced. They are skipped without being produced at all when the enumerator supports it.
+    template <typename Enumerable>
+    auto sample(const Enumerable& enumerable, size_t k, std::uint64_t seed)
+    {
+        static_assert(Enumerable::is_enumerable, "Oops.");
+        using stored_type = enumerated_type<decltype(enumerable.get_enumerator())>;
+
+        std::vector<stored_type> reservoir;
+        if (k == 0)
+            return reservoir;
+
+        auto enumerator = enumerable.get_enumerator();
+        for (size_t i = 0; i < k; ++i)
+        {
+            auto&& next = enumerator.next();
+            if (!has_more(next))
+                return reservoir;
+            reservoir.push_back(forward_value(next));
+        }
+
+        std::mt19937_64 generator(seed);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        std::uniform_int_distribution<size_t> slot(0, k - 1);
+
+        // In (0, 1], so that the logarithm is finite
+        auto random = [&] { return 1.0 - uniform(generator); };
+
+        double w = std::exp(std::log(random()) / static_cast<double>(k));
+        for (;;)
+        {
+            double skipped = std::floor(std::log(random()) / std::log1p(-w));
+            if (!(skipped < static_cast<double>(std::numeric_limits<size_t>::max() / 2)))
+                return reservoir;
+
+            details::skip_elements(enumerator, static_cast<size_t>(skipped));
+            auto&& next = enumerator.next();
+            if (!has_more(next))
+                return reservoir;
+
+            reservoir[slot(generator)] = forward_value(next);
+            w *= std::exp(std::log(random()) / static_cast<double>(k));
+        }
+    }
+
+    template <typename T>
+    class Sample
+    {
+    public:
+
+        Sample(size_t k, std::uint64_t seed) :
+            _k(k),
+            _seed(seed)
+        {}
+
+        template <typename Enumerable>
+        std::vector<T> apply(const Enumerable& enumerable) const
+        {
+            return sample(enumerable, _k, _seed);
+        }
+
+    private:
+
+        size_t _k;
+        std::uint64_t _seed;
+    };
+
+    template <typename Enumerable, typename T>
+    std::vector<T> operator >> (const Enumerable& enumerable, const Sample<T>& fold)
+    {
+        return fold.apply(enumerable);
+    }
+
+    template <typename T>
+    Sample<T> sample(size_t k, std::uint64_t seed)
+    {
+        return Sample<T>(k, seed);
+    }
+
+#pragma endregion
+
+#pragma region Group by
+
+    // Aggregators fold the elements of a group into a state, one element at a time:
+    /*
+
+    struct Aggregator
+    {
+        // The state of a group, from its first element
+        State start(const T& value) const;
+
+        // Adds another element of the group
+        void add(State& state, const T& value) const;
+
+        // Adds the state of another part of the same group
+        void merge(State& state, State other) const;
+    };
+
+    */
+
+    class CountAggregator
+    {
+    public:
+
+        template <typename T>
+        size_t start(const T&) const
+        {
+            return 1;
+        }
+
+        template <typename T>
+        void add(size_t& state, const T&) const
+        {
+            ++state;
+        }
+
+        void merge(size_t& state, size_t other) const
+        {
+            state += other;
+        }
+    };
+
+    template <typename Field>
+    class SumAggregator
+    {
+    public:
+
+        SumAggregator(Field field) :
+            _field(std::move(field))
+        {}
+
+        template <typename T>
+        auto start(const T& value) const
+        {
+            return _field(value);
+        }
+
+        template <typename State, typename T>
+        void add(State& state, const T& value) const
+        {
+            state += _field(value);
+        }
+
+        template <typename State>
+        void merge(State& state, State other) const
+        {
+            state += std::move(other);
+        }
+
+    private:
+
+        Field _field;
+    };
+
+    // Keeps the field that comes last in the order of Compare
+    template <typename Field, typename Compare>
+    class ExtremumAggregator
+    {
+    public:
+
+        ExtremumAggregator(Field field) :
+            _field(std::move(field))
+        {}
+
+        template <typename T>
+        auto start(const T& value) const
+        {
+            return _field(value);
+        }
+
+        template <typename State, typename T>
+        void add(State& state, const T& value) const
+        {
+            merge(state, _field(value));
+        }
+
+        template <typename State>
+        void merge(State& state, State other) const
+        {
+            if (Compare()(state, other))
+                state = std::move(other);
+        }
+
+    private:
+
+        Field _field;
+    };
+
+    inline CountAggregator aggregate_count()
+    {
+        return CountAggregator();
+    }
+
+    template <typename Field>
+    SumAggregator<Field> aggregate_sum(Field field)
+    {
+        return SumAggregator<Field>(std::move(field));
+    }
+
+    template <typename Field>
+    ExtremumAggregator<Field, std::less<>> aggregate_max(Field field)
+    {
+        return ExtremumAggregator<Field, std::less<>>(std::move(field));
+    }
+
+    template <typename Field>
+    ExtremumAggregator<Field, std::greater<>> aggregate_min(Field field)
+    {
+        return ExtremumAggregator<Field, std::greater<>>(std::move(field));
+    }
+
+
+    // The aggregate of the elements of every key, in a hash map from the keys to the states of their aggregators.
+    // Elements are aggregated as they stream past, with a single hash lookup each, 
+    // so that memory only grows with the number of keys.
+    template <typename Enumerable, typename KeySelector, typename Aggregator>
+    auto to_groups(const Enumerable& enumerable, const KeySelector& key, const Aggregator& aggregator)
+    {
+        static_assert(Enumerable::is_enumerable, "Oops.");
+        using stored_type = enumerated_type<decltype(enumerable.get_enumerator())>;
+        using key_type = std::decay_t<decltype(key(std::declval<const stored_type&>()))>;
+        using state_type = std::decay_t<decltype(aggregator.start(std::declval<const stored_type&>()))>;
+
+        FlatHashMap<key_type, state_type> groups;
+        for_each(enumerable, [&](const auto& value)
+        {
+            auto found = groups.find_or_insert_with(key(value), [&] { return aggregator.start(value); });
+            if (!found.second)
+                aggregator.add(found.first->second, value);
+        });
+
+        return groups;
+    }
+
+    template <typename KeySelector, typename Aggregator>
+    class ToGroups
+    {
+    public:
+
+        ToGroups(KeySelector key, Aggregator aggregator) :
+            _key(std::move(key)),
+            _aggregator(std::move(aggregator))
+        {}
+
+        template <typename Enumerable>
+        auto apply(const Enumerable& enumerable) const
+        {
+            return to_groups(enumerable, _key, _aggregator);
+        }
+
+    private:
+
+        KeySelector _key;
+        Aggregator _aggregator;
+    };
+
+    template <typename Enumerable, typename KeySelector, typename Aggregator>
+    auto operator >> (const Enumerable& enumerable, const ToGroups<KeySelector, Aggregator>& fold)
+    {
+        return fold.apply(enumerable);
+    }
+
+    template <typename KeySelector, typename Aggregator>
+    ToGroups<KeySelector, Aggregator> to_groups(KeySelector key, Aggregator aggregator)
+    {
+        return ToGroups<KeySelector, Aggregator>(std::move(key), std::move(aggregator));
+    }
+
+
+    namespace details
+    {
+        // The groups in a single partition. Parallel enumerables have their own overload, which partitions them.
+        template <typename Enumerable, typename KeySelector, typename Aggregator>
+        auto group_partitions(const Enumerable& enumerable, const KeySelector& key, const Aggregator& aggregator)
+        {
+            std::vector<decltype(to_groups(enumerable, key, aggregator))> groups;
+            groups.push_back(to_groups(enumerable, key, aggregator));
+            return groups;
+        }
+    }
+
+    // An enumerator over maps that it owns, one after the other, moving their elements out
+    template <typename Map>
+    class GroupsEnumerator
+    {
+    public:
+
+        static const bool is_enumerator = true;
+
+        GroupsEnumerator(std::vector<Map> partitions) :
+            _partitions(std::move(partitions)),
+            _partition(0)
+        {
+            if (!_partitions.empty())
+                _current = _partitions.front().begin();
+        }
+
+        // The iterator points to the storage of a map, which moves along with it
+        GroupsEnumerator(GroupsEnumerator&& other) noexcept :
+            _partitions(std::move(other._partitions)),
+            _partition(other._partition),
+            _current(other._current)
+        {}
+
+        GroupsEnumerator(const GroupsEnumerator&) = delete;
+
+        auto next()
+        {
+            for (; _partition != _partitions.size(); _current = _partitions[_partition].begin())
+            {
+                if (_current != _partitions[_partition].end())
+                    return yield_some(std::move(*_current++));
+
+                if (++_partition == _partitions.size())
+                    break;
+            }
+            return yield_none<typename Map::value_type>();
+        }
+
+    private:
+
+        std::vector<Map> _partitions;
+        size_t _partition;
+        typename Map::iterator _current;
+    };
+
+    // The aggregate of every key, as std::pair<Key, State> in no particular order, for instance:
+    //
+    // from(sales) >> group_by([](const Sale& s) { return s.product; }, aggregate_sum([](const Sale& s) { return s.amount; }))
+    //
+    // The groups are aggregated once per enumeration, when the enumerator is created. 
+    // After parallel(), they are aggregated in partitions on the pool, and enumerated one partition after the other.
+    template <typename Enumerable, typename KeySelector, typename Aggregator>
+    class GroupByEnumerable
+    {
+    public:
+
+        static const bool is_enumerable = true;
+        using partitions_type = decltype(details::group_partitions(
+            std::declval<const Enumerable&>(), std::declval<const KeySelector&>(), std::declval<const Aggregator&>()));
+        using enumerator = GroupsEnumerator<typename partitions_type::value_type>;
+
+        GroupByEnumerable(Enumerable enumerable, KeySelector key, Aggregator aggregator) :
+            _enumerable(std::move(enumerable)),
+            _key(std::move(key)),
+            _aggregator(std::move(aggregator))
+        {
+        }
+
+        enumerator get_enumerator() const
+        {
+            return enumerator(details::group_partitions(_enumerable, _key, _aggregator));
+        }
+
+        template <typename Sink>
+        void push_to(Sink& sink) const
+        {
+            auto partitions = details::group_partitions(_enumerable, _key, _aggregator);
+            for (auto& partition : partitions)
+            {
+                for (auto& group : partition)
+                    sink(std::move(group));
+            }
+        }
+
+        std::optional<SizeHint> size_hint() const
+        {
+            return at_most(get_size_hint(_enumerable));
+        }
+
+    private:
+
+        Enumerable _enumerable;
+        KeySelector _key;
+        Aggregator _aggregator;
+    };
+
+    template <typename KeySelector, typename Aggregator>
+    class GroupBy
+    {
+    public:
+
+        GroupBy(KeySelector key, Aggregator aggregator) :
+            _key(std::move(key)),
+            _aggregator(std::move(aggregator))
+        {}
+
+        template <typename Enumerable>
+        GroupByEnumerable<std::decay_t<Enumerable>, KeySelector, Aggregator> apply(Enumerable&& enumerable) &&
+        {
+            return { std::forward<Enumerable>(enumerable), std::move(_key), std::move(_aggregator) };
+        }
+
+    private:
+
+        KeySelector _key;
+        Aggregator _aggregator;
+    };
+
+    template <typename Enumerable, typename KeySelector, typename Aggregator>
+    auto operator >> (Enumerable&& enumerable, GroupBy<KeySelector, Aggregator> groupBy)
+    {
+        return std::move(groupBy).apply(std::forward<Enumerable>(enumerable));
+    }
+
+    template <typename KeySelector, typename Aggregator>
+    GroupBy<KeySelector, Aggregator> group_by(KeySelector key, Aggregator aggregator)
+    {
+        return GroupBy<KeySelector, Aggregator>(std::move(key), std::move(aggregator));
+    }
+
+#pragma endregion
+
+#pragma region Join
+
+    namespace details
+    {
+        // The build side of a hash join: the elements of the inner enumerable, with the elements of every key next to each other,
+        // in the order of the inner enumerable, and a flat hash table from every key to its elements.
+        // The elements are chained by key while they are collected, and then permuted in place so that every chain is contiguous,
+        // unless they all already are: probing a key takes a single lookup and finds all its elements in a row.
+        // When every key has a single element, as with the primary keys of a dimension table, the elements are moved 
+        // into the hash table itself instead, which saves probes a second access to memory.
+        template <typename Key, typename Row>
+        class JoinTable
+        {
+        public:
+
+            using row_type = Row;
+
+            template <typename Enumerable, typename KeySelector>
+            JoinTable(const Enumerable& inner, const KeySelector& key)
+            {
+                const size_t none = size_t(-1);
+                std::vector<size_t> next;
+                size_t reserved = reserved_size(get_size_hint(inner));
+                _rows.reserve(reserved);
+                next.reserve(reserved);
+                bool contiguous = true;
+
+                // The first and last elements of every key, until they are permuted
+                for_each(inner, [&](auto&& value)
+                {
+                    size_t row = _rows.size();
+                    auto found = _keys.find_or_insert_with(key(std::as_const(value)), [&] { return Range{ row, row }; });
+                    if (!found.second)
+                    {
+                        contiguous = contiguous && found.first->second.last + 1 == row;
+                        next[found.first->second.last] = row;
+                        found.first->second.last = row;
+                    }
+
+                    next.push_back(none);
+                    _rows.push_back(std::forward<decltype(value)>(value));
+                });
+
+                if (_keys.size() == _rows.size())
+                {
+                    _unique.reserve(_keys.size());
+                    for (const auto& entry : _keys)
+                        _unique.try_emplace(entry.first, std::move(_rows[entry.second.first]));
+                    _keys = FlatHashMap<Key, Range>();
+                    _rows = std::vector<Row>();
+                    return;
+                }
+
+                if (contiguous)
+                {
+                    for (auto& entry : _keys)
+                        entry.second.last += 1;
+                    return;
+                }
+
+                // The chains are replaced by the position of every element, and the elements then follow the cycles of the permutation
+                auto& position = next;
+                size_t offset = 0;
+                for (auto& entry : _keys)
+                {
+                    size_t first = offset;
+                    for (size_t row = entry.second.first; row != none;)
+                    {
+                        size_t following = next[row];
+                        position[row] = offset++;
+                        row = following;
+                    }
+
+                    entry.second = Range{ first, offset };
+                }
+
+                for (size_t row = 0; row != _rows.size(); ++row)
+                {
+                    while (position[row] != row)
+                    {
+                        size_t target = position[row];
+                        std::swap(_rows[row], _rows[target]);
+                        std::swap(position[row], position[target]);
+                    }
+                }
+            }
+
+            // The elements with the key, as a range of pointers, empty when there is none
+            std::pair<const Row*, const Row*> find(const Key& key) const
+            {
+                if (!_unique.empty())
+                {
+                    auto found = _unique.find(key);
+                    if (found == _unique.end())
+                        return { nullptr, nullptr };
+
+                    return { &found->second, &found->second + 1 };
+                }
+
+                auto found = _keys.find(key);
+                if (found == _keys.end())
+                    return { nullptr, nullptr };
+
+                return { _rows.data() + found->second.first, _rows.data() + found->second.last };
+            }
+
+        private:
+
+            struct Range
+            {
+                size_t first;
+                size_t last;
+            };
+
+            FlatHashMap<Key, Range> _keys;
+            std::vector<Row> _rows;
+            FlatHashMap<Key, Row> _unique;
+        };
+
+        // The build side of semi and anti joins, which only need the keys
+        template <typename Key>
+        class JoinTable<Key, void>
+        {
+        public:
+
+            template <typename Enumerable, typename KeySelector>
+            JoinTable(const Enumerable& inner, const KeySelector& key)
+            {
+                for_each(inner, [&](const auto& value)
+                {
+                    _keys.insert(key(value));
+                });
+            }
+
+            bool contains(const Key& key) const
+            {
+                return _keys.contains(key);
+            }
+
+        private:
+
+            FlatHashSet<Key> _keys;
+        };
+
+        template <typename Enumerable, typename KeySelector>
+        using join_key_type = std::decay_t<decltype(std::declval<const KeySelector&>()(
+            std::declval<const enumerated_type<typename Enumerable::enumerator>&>()))>;
+    }
+
+    // Pulls the outer elements one at a time, and yields the result of every element of the table that matches each of them.
+    // Outer elements without a match are skipped before being copied out of the underlying enumerator.
+    template <typename Enumerator, typename Table, typename OuterKey, typename ResultSelector>
+    class JoinEnumerator
+    {
+    public:
+
+        static const bool is_enumerator = true;
+        using outer_type = enumerated_type<Enumerator>;
+
+        JoinEnumerator(Enumerator enumerator, std::shared_ptr<const Table> table, OuterKey outer_key, ResultSelector result) :
+            _enumerator(std::move(enumerator)),
+            _table(std::move(table)),
+            _outer_key(std::move(outer_key)),
+            _result(std::move(result)),
+            _matches(nullptr, nullptr)
+        {
+        }
+
+        auto next()
+        {
+            using result_type = std::decay_t<decltype(_result(*_outer, *_matches.first))>;
+
+            for (;;)
+            {
+                if (_matches.first != _matches.second)
+                    return yield_some<result_type>(_result(std::as_const(*_outer), *_matches.first++));
+
+                auto current = _enumerator.next();
+                if (!has_more(current))
+                    return yield_none<result_type>();
+
+                _matches = _table->find(_outer_key(std::as_const(get_value_by_ref(current))));
+                if (_matches.first != _matches.second)
+                    _outer = forward_value(current);
+            }
+        }
+
+    private:
+
+        Enumerator _enumerator;
+        std::shared_ptr<const Table> _table;
+        OuterKey _outer_key;
+        ResultSelector _result;
+        std::optional<outer_type> _outer;
+        std::pair<const typename Table::row_type*, const typename Table::row_type*> _matches;
+    };
+
+    // The inner join of two enumerables on equal keys, for instance:
+    //
+    // from(events) >> join(from(users), [](const Event& e) { return e.user; }, [](const User& u) { return u.id; }, 
+    //     [](const Event& e, const User& u) { return std::make_pair(u.name, e.time); })
+    //
+    // The inner enumerable is the build side: it is collected into a hash table once per enumeration, 
+    // and should be the smaller of the two. The outer enumerable is the probe side, which is streamed and never stored,
+    // so the results come in the order of the outer elements, and then of the inner elements that match each of them.
+    // The sides are never swapped, even when the size hints tell that the outer enumerable is the smaller one:
+    // building on the outer side would give the results in the order of the inner elements.
+    template <typename Outer, typename Inner, typename OuterKey, typename InnerKey, typename ResultSelector>
+    class JoinEnumerable
+    {
+    public:
+
+        static const bool is_enumerable = true;
+        using table_type = details::JoinTable<
+            details::join_key_type<Inner, InnerKey>, enumerated_type<typename Inner::enumerator>>;
+        using enumerator = JoinEnumerator<typename Outer::enumerator, table_type, OuterKey, ResultSelector>;
+
+        JoinEnumerable(Outer outer, Inner inner, OuterKey outer_key, InnerKey inner_key, ResultSelector result) :
+            _outer(std::move(outer)),
+            _inner(std::move(inner)),
+            _outer_key(std::move(outer_key)),
+            _inner_key(std::move(inner_key)),
+            _result(std::move(result))
+        {
+        }
+
+        enumerator get_enumerator() const
+        {
+            return enumerator(_outer.get_enumerator(), std::make_shared<const table_type>(_inner, _inner_key), _outer_key, _result);
+        }
+
+        template <typename Sink>
+        void push_to(Sink& sink) const
+        {
+            table_type table(_inner, _inner_key);
+            for_each(_outer, [&](const auto& value)
+            {
+                for (auto matches = table.find(_outer_key(value)); matches.first != matches.second; ++matches.first)
+                    sink(_result(value, *matches.first));
+            });
+        }
+
+    private:
+
+        Outer _outer;
+        Inner _inner;
+        OuterKey _outer_key;
+        InnerKey _inner_key;
+        ResultSelector _result;
+    };
+
+    template <typename Inner, typename OuterKey, typename InnerKey, typename ResultSelector>
+    class Join
+    {
+    public:
+
+        Join(Inner inner, OuterKey outer_key, InnerKey inner_key, ResultSelector result) :
+            _inner(std::move(inner)),
+            _outer_key(std::move(outer_key)),
+            _inner_key(std::move(inner_key)),
+            _result(std::move(result))
+        {}
+
+        template <typename Outer>
+        JoinEnumerable<std::decay_t<Outer>, Inner, OuterKey, InnerKey, ResultSelector> apply(Outer&& outer) &&
+        {
+            return { std::forward<Outer>(outer), std::move(_inner), std::move(_outer_key), std::move(_inner_key), std::move(_result) };
+        }
+
+    private:
+
+        Inner _inner;
+        OuterKey _outer_key;
+        InnerKey _inner_key;
+        ResultSelector _result;
+    };
+
+    template <typename Outer, typename Inner, typename OuterKey, typename InnerKey, typename ResultSelector>
+    auto operator >> (Outer&& outer, Join<Inner, OuterKey, InnerKey, ResultSelector> join)
+    {
+        return std::move(join).apply(std::forward<Outer>(outer));
+    }
+
+    template <typename Inner, typename OuterKey, typename InnerKey, typename ResultSelector>
+    Join<std::decay_t<Inner>, OuterKey, InnerKey, ResultSelector> join(Inner&& inner, OuterKey outer_key, InnerKey inner_key, ResultSelector result)
+    {
+        static_assert(std::decay_t<Inner>::is_enumerable, "Oops.");
+        return { std::forward<Inner>(inner), std::move(outer_key), std::move(inner_key), std::move(result) };
+    }
+
+
+    namespace details
+    {
+        // Whether the key of an outer element is in the table, or not in it when Keep is false
+        template <typename Table, typename OuterKey, bool Keep>
+        class JoinFilter
+        {
+        public:
+
+            JoinFilter(std::shared_ptr<const Table> table, OuterKey outer_key) :
+                _table(std::move(table)),
+                _outer_key(std::move(outer_key))
+            {}
+
+            template <typename T>
+            bool operator()(const T& value) const
+            {
+                return _table->contains(_outer_key(value)) == Keep;
+            }
+
+        private:
+
+            std::shared_ptr<const Table> _table;
+            OuterKey _outer_key;
+        };
+    }
+
+    // The outer elements whose key is (or is not, when Keep is false) the key of some inner element, each of them once,
+    // in their order. Only the distinct keys of the inner enumerable are collected, once per enumeration.
+    template <typename Outer, typename Inner, typename OuterKey, typename InnerKey, bool Keep>
+    class WhereInEnumerable
+    {
+    public:
+
+        static const bool is_enumerable = true;
+        using table_type = details::JoinTable<details::join_key_type<Inner, InnerKey>, void>;
+        using filter_type = details::JoinFilter<table_type, OuterKey, Keep>;
+        using enumerator = WhereEnumerator<typename Outer::enumerator, filter_type>;
+
+        WhereInEnumerable(Outer outer, Inner inner, OuterKey outer_key, InnerKey inner_key) :
+            _outer(std::move(outer)),
+            _inner(std::move(inner)),
+            _outer_key(std::move(outer_key)),
+            _inner_key(std::move(inner_key))
+        {
+        }
+
+        enumerator get_enumerator() const
+        {
+            return enumerator(_outer.get_enumerator(), filter());
+        }
+
+        template <typename Sink>
+        void push_to(Sink& sink) const
+        {
+            auto keep = filter();
+            for_each(_outer, [&](auto&& value)
+            {
+                if (keep(std::as_const(value)))
+                    sink(std::forward<decltype(value)>(value));
+            });
+        }
+
+        std::optional<SizeHint> size_hint() const
+        {
+            return at_most(get_size_hint(_outer));
+        }
+
+    private:
+
+        filter_type filter() const
+        {
+            return filter_type(std::make_shared<const table_type>(_inner, _inner_key), _outer_key);
+        }
+
+        Outer _outer;
+        Inner _inner;
+        OuterKey _outer_key;
+        InnerKey _inner_key;
+    };
+
+    template <typename Inner, typename OuterKey, typename InnerKey, bool Keep>
+    class WhereIn
+    {
+    public:
+
+        WhereIn(Inner inner, OuterKey outer_key, InnerKey inner_key) :
+            _inner(std::move(inner)),
+            _outer_key(std::move(outer_key)),
+            _inner_key(std::move(inner_key))
+        {}
+
+        template <typename Outer>
+        WhereInEnumerable<std::decay_t<Outer>, Inner, OuterKey, InnerKey, Keep> apply(Outer&& outer) &&
+        {
+            return { std::forward<Outer>(outer), std::move(_inner), std::move(_outer_key), std::move(_inner_key) };
+        }
+
+    private:
+
+        Inner _inner;
+        OuterKey _outer_key;
+        InnerKey _inner_key;
+    };
+
+    template <typename Outer, typename Inner, typename OuterKey, typename InnerKey, bool Keep>
+    auto operator >> (Outer&& outer, WhereIn<Inner, OuterKey, InnerKey, Keep> whereIn)
+    {
+        return std::move(whereIn).apply(std::forward<Outer>(outer));
+    }
+
+    // The semi join: the outer elements that have a match in the inner enumerable
+    template <typename Inner, typename OuterKey, typename InnerKey>
+    WhereIn<std::decay_t<Inner>, OuterKey, InnerKey, true> where_in(Inner&& inner, OuterKey outer_key, InnerKey inner_key)
+    {
+        static_assert(std::decay_t<Inner>::is_enumerable, "Oops.");
+        return { std::forward<Inner>(inner), std::move(outer_key), std::move(inner_key) };
+    }
+
+    // The anti join: the outer elements that have no match in the inner enumerable
+    template <typename Inner, typename OuterKey, typename InnerKey>
+    WhereIn<std::decay_t<Inner>, OuterKey, InnerKey, false> where_not_in(Inner&& inner, OuterKey outer_key, InnerKey inner_key)
+    {
+        static_assert(std::decay_t<Inner>::is_enumerable, "Oops.");
+        return { std::forward<Inner>(inner), std::move(outer_key), std::move(inner_key) };
+    }
+
+    // Walks two enumerators in ascending order of their keys in lockstep, and yields the result of every pair of equal keys.
+    // Only the current run of inner elements with the same key is kept, to be matched with every outer element of that key:
+    // memory does not grow with the inputs, only with the longest run of duplicate inner keys.
+    template <typename OuterEnumerator, typename InnerEnumerator, typename OuterKey, typename InnerKey, typename ResultSelector>
+    class MergeJoinEnumerator
+    {
+    public:
+
+        static const bool is_enumerator = true;
+        using outer_type = enumerated_type<OuterEnumerator>;
+        using inner_type = enumerated_type<InnerEnumerator>;
+        using key_type = std::decay_t<decltype(std::declval<const InnerKey&>()(std::declval<const inner_type&>()))>;
+
+        MergeJoinEnumerator(OuterEnumerator outer, InnerEnumerator inner, OuterKey outer_key, InnerKey inner_key, ResultSelector result) :
+            _outer(std::move(outer)),
+            _inner(std::move(inner)),
+            _outer_key(std::move(outer_key)),
+            _inner_key(std::move(inner_key)),
+            _result(std::move(result)),
+            _started(false),
+            _position(0)
+        {
+        }
+
+        auto next()
+        {
+            using result_type = std::decay_t<decltype(_result(std::declval<const outer_type&>(), std::declval<const inner_type&>()))>;
+
+            for (;;)
+            {
+                if (_position != _run.size())
+                    return yield_some<result_type>(_result(std::as_const(*_current), std::as_const(_run[_position++])));
+
+                auto current = _outer.next();
+                if (!has_more(current))
+                    return yield_none<result_type>();
+
+                // Outer elements of the same key as the previous one are matched with the same run
+                const auto& key = _outer_key(std::as_const(get_value_by_ref(current)));
+                if (!_run_key || *_run_key < key || key < *_run_key)
+                {
+                    // Once the inner elements are exhausted, no later outer element can match.
+                    // The run is empty then, so that the end is returned again on the next calls.
+                    if (!advance(key))
+                    {
+                        _position = 0;
+                        return yield_none<result_type>();
+                    }
+                }
+
+                _position = 0;
+                if (!_run.empty())
+                    _current = forward_value(current);
+            }
+        }
+
+    private:
+
+        void pull()
+        {
+            auto current = _inner.next();
+            if (has_more(current))
+                _pending = forward_value(current);
+            else
+                _pending.reset();
+        }
+
+        // Skips the inner elements below the key and collects those equal to it.
+        // Returns false when no inner element is left for this key or the next ones.
+        template <typename Key>
+        bool advance(const Key& key)
+        {
+            if (!_started)
+            {
+                pull();
+                _started = true;
+            }
+
+            _run.clear();
+            _run_key = key;
+
+            while (_pending && _inner_key(std::as_const(*_pending)) < key)
+                pull();
+
+            while (_pending && !(key < _inner_key(std::as_const(*_pending))))
+            {
+                _run.push_back(std::move(*_pending));
+                pull();
+            }
+
+            return !_run.empty() || _pending;
+        }
+
+        OuterEnumerator _outer;
+        InnerEnumerator _inner;
+        OuterKey _outer_key;
+        InnerKey _inner_key;
+        ResultSelector _result;
+
+        bool _started;
+        std::optional<inner_type> _pending;
+        std::optional<key_type> _run_key;
+        std::vector<inner_type> _run;
+        size_t _position;
+        std::optional<outer_type> _current;
+    };
+
+    // The inner join of two enumerables that both come in ascending order of their keys, for instance:
+    //
+    // from(trades) >> assume_ordered_by<Trade>(time) >> merge_join(from(quotes) >> assume_ordered_by<Quote>(time), result)
+    //
+    // Neither side is collected into a table, so inputs larger than memory can be joined as they stream past.
+    // The results come in the order of the keys, then of the outer elements, and then of the inner elements of each key.
+    template <typename Outer, typename Inner, typename OuterKey, typename InnerKey, typename ResultSelector>
+    class MergeJoinEnumerable
+    {
+    public:
+
+        static const bool is_enumerable = true;
+        using enumerator = MergeJoinEnumerator<typename Outer::enumerator, typename Inner::enumerator, OuterKey, InnerKey, ResultSelector>;
+
+        MergeJoinEnumerable(Outer outer, Inner inner, OuterKey outer_key, InnerKey inner_key, ResultSelector result) :
+            _outer(std::move(outer)),
+            _inner(std::move(inner)),
+            _outer_key(std::move(outer_key)),
+            _inner_key(std::move(inner_key)),
+            _result(std::move(result))
+        {
+        }
+
+        enumerator get_enumerator() const
+        {
+            return enumerator(_outer.get_enumerator(), _inner.get_enumerator(), _outer_key, _inner_key, _result);
+        }
+
+    private:
+
+        Outer _outer;
+        Inner _inner;
+        OuterKey _outer_key;
+        InnerKey _inner_key;
+        ResultSelector _result;
+    };
+
+    template <typename Inner, typename OuterKey, typename InnerKey, typename ResultSelector>
+    class MergeJoin
+    {
+    public:
+
+        MergeJoin(Inner inner, OuterKey outer_key, InnerKey inner_key, ResultSelector result) :
+            _inner(std::move(inner)),
+            _outer_key(std::move(outer_key)),
+            _inner_key(std::move(inner_key)),
+            _result(std::move(result))
+        {}
+
+        template <typename Outer>
+        MergeJoinEnumerable<std::decay_t<Outer>, Inner, OuterKey, InnerKey, ResultSelector> apply(Outer&& outer) &&
+        {
+            return { std::forward<Outer>(outer), std::move(_inner), std::move(_outer_key), std::move(_inner_key), std::move(_result) };
+        }
+
+    private:
+
+        Inner _inner;
+        OuterKey _outer_key;
+        InnerKey _inner_key;
+        ResultSelector _result;
+    };
+
+    template <typename Outer, typename Inner, typename OuterKey, typename InnerKey, typename ResultSelector>
+    auto operator >> (Outer&& outer, MergeJoin<Inner, OuterKey, InnerKey, ResultSelector> join)
+    {
+        return std::move(join).apply(std::forward<Outer>(outer));
+    }
+
+    // Both enumerables must already be in ascending order of the keys given here
+    template <typename Inner, typename OuterKey, typename InnerKey, typename ResultSelector>
+    MergeJoin<std::decay_t<Inner>, OuterKey, InnerKey, ResultSelector> merge_join(Inner&& inner, OuterKey outer_key, InnerKey inner_key, ResultSelector result)
+    {
+        static_assert(std::decay_t<Inner>::is_enumerable, "Oops.");
+        return { std::forward<Inner>(inner), std::move(outer_key), std::move(inner_key), std::move(result) };
+    }
+
+
+    // The merge join of two ordered enumerables, from order_by or assume_ordered_by, on the keys of their orders
+    template <typename Inner, typename ResultSelector>
+    class MergeJoinOrdered
+    {
+    public:
+
+        MergeJoinOrdered(Inner inner, ResultSelector result) :
+            _inner(std::move(inner)),
+            _result(std::move(result))
+        {}
+
+        template <typename Outer>
+        auto apply(Outer&& outer) &&
+        {
+            auto outer_key = outer.ordered_key();
+            auto inner_key = _inner.ordered_key();
+            return MergeJoinEnumerable<std::decay_t<Outer>, Inner, decltype(outer_key), decltype(inner_key), ResultSelector>(
+                std::forward<Outer>(outer), std::move(_inner), std::move(outer_key), std::move(inner_key), std::move(_result));
+        }
+
+    private:
+
+        Inner _inner;
+        ResultSelector _result;
+    };
+
+    template <typename Outer, typename Inner, typename ResultSelector>
+    auto operator >> (Outer&& outer, MergeJoinOrdered<Inner, ResultSelector> join)
+    {
+        return std::move(join).apply(std::forward<Outer>(outer));
+    }
+
+    template <typename Inner, typename ResultSelector>
+    MergeJoinOrdered<std::decay_t<Inner>, ResultSelector> merge_join(Inner&& inner, ResultSelector result)
+    {
+        static_assert(std::decay_t<Inner>::is_enumerable, "Oops.");
+        return { std::forward<Inner>(inner), std::move(result) };
+    }
+
 #pragma endregion
 }
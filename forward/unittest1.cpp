@@ -3,6 +3,12 @@
 
 #include <vector>
 #include <string>
+#include <list>
+#include <forward_list>
+#include <atomic>
+#include <stdexcept>
+#include <fstream>
+#include <filesystem>
 
 #include "forward.h"
 
@@ -10,6 +16,20 @@ using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
 namespace forward
 {
+    namespace
+    {
+        // A type that counts how many of its values are default constructed
+        struct Counted
+        {
+            static inline int default_constructions = 0;
+
+            Counted() { ++default_constructions; }
+            Counted(int i) : value(i) {}
+
+            int value = 0;
+        };
+    }
+
     TEST_CLASS(UnitTest1)
     {
     public:
@@ -154,6 +174,58 @@ namespace forward
         }
 
 
+        TEST_METHOD(OwningStages)
+        {
+            using namespace forward;
+            std::vector<int> v{ 5, 1, 4, 2, 3, 4, 5 };
+
+            // A pipeline returned from a function, whose temporaries and captures are gone when it is enumerated
+            auto make_query = [&v](int threshold)
+            {
+                return from(v)
+                    >> where([threshold](int i) { return i > threshold; })
+                    >> select([threshold](int i) { return std::to_string(i - threshold); })
+                    >> take(3);
+            };
+
+            // Kept in a cache and enumerated again
+            std::vector<decltype(make_query(0))> cache;
+            for (int threshold = 0; threshold < 3; ++threshold)
+                cache.push_back(make_query(threshold));
+
+            for (int pass = 0; pass < 2; ++pass)
+            {
+                assert((cache[0] >> to_vector<std::string>()) == std::vector<std::string>({ "5", "1", "4" }));
+                assert((cache[2] >> to_vector<std::string>()) == std::vector<std::string>({ "3", "2", "1" }));
+            }
+
+            // Pipelines that own their source
+            auto make_owning = []
+            {
+                return from_moved(std::vector<int>{ 3, 1, 2, 3 }) >> distinct<int>() >> reverse() >> skip(1);
+            };
+            auto owning = make_owning();
+            assert((owning >> to_vector<int>()) == std::vector<int>({ 1, 3 }));
+            assert((owning >> count()) == 2);
+
+            auto make_zipped = [&v]
+            {
+                return zip(from(v), range(0, 100) >> select([](int i) { return i * 10; }))
+                    >> select([](const auto& t) { return std::get<0>(t) + std::get<1>(t); })
+                    >> parallel()
+                    >> shuffle(1);
+            };
+            auto zipped = make_zipped();
+            auto sums = zipped >> to_vector<int>();
+            std::sort(sums.begin(), sums.end());
+            assert(sums == std::vector<int>({ 5, 11, 24, 32, 43, 54, 65 }));
+
+            // Moved pipelines move their captures along
+            auto shifted = from(v) >> select([offset = std::vector<int>(1000, 100)](int i) { return i + offset[0]; });
+            auto moved = std::move(shifted);
+            assert((moved >> first<int>()) == 105);
+        }
+
         TEST_METHOD(ToSet1)
         {
             using namespace forward;
@@ -178,6 +250,701 @@ namespace forward
             }
         }
      
+        TEST_METHOD(FlatHashSet1)
+        {
+            using namespace forward;
+
+            FlatHashSet<int> set;
+            assert(set.empty() && set.begin() == set.end());
+            assert(!set.contains(3));
+
+            // Growing through several capacities, with duplicates
+            for (int i = 0; i < 10000; ++i)
+                set.insert(i % 3000 * 7);
+            assert(set.size() == 3000);
+            assert(set.contains(2999 * 7) && !set.contains(3000 * 7) && !set.contains(1));
+            assert(!set.insert(7).second && set.insert(-1).second);
+            assert(*set.find(-1) == -1 && set.find(1) == set.end());
+
+            // Erasing leaves the other elements reachable, and their slots are reused
+            for (int i = 0; i < 3000; i += 2)
+                assert(set.erase(i * 7) == 1);
+            assert(set.erase(0) == 0);
+            assert(set.size() == 1501);
+            assert(set.contains(7) && !set.contains(14));
+            for (int i = 0; i < 100000; ++i)
+            {
+                set.insert(1000000 + i);
+                set.erase(1000000 + i);
+            }
+            assert(set.size() == 1501 && set.count(2999 * 7) == 1);
+
+            size_t iterated = 0;
+            for (int value : set)
+                iterated += value == -1 || value % 14 == 7;
+            assert(iterated == set.size());
+
+            // Copies, moves and merges
+            FlatHashSet<std::string> words{ "cat", "bunny", "cat", "doggy" };
+            auto copy = words;
+            FlatHashSet<std::string> other{ "doggy", "horsey" };
+            words.merge(other);
+            assert(other.empty());
+            assert((words == FlatHashSet<std::string>{ "cat", "bunny", "doggy", "horsey" }));
+            auto moved = std::move(words);
+            assert(moved.size() == 4 && copy.size() == 3 && copy != moved);
+
+            // to_set fills a flat set, and to_unordered_set the standard one
+            std::vector<std::string> v{ "cat", "bunny", "cat", "doggy", "bunny" };
+            auto flat = from(v) >> to_set<std::string>();
+            auto unordered = from(v) >> to_unordered_set<std::string>();
+            assert(flat.size() == 3 && unordered.size() == 3);
+            for (const auto& s : unordered)
+                assert(flat.contains(s));
+        }
+
+        TEST_METHOD(GroupBy1)
+        {
+            using namespace forward;
+
+            FlatHashMap<std::string, int> map{ { "cat", 1 }, { "bunny", 2 } };
+            map["cat"] += 10;
+            map["doggy"] = 3;
+            assert(map.size() == 3 && map["cat"] == 11 && map.find("horsey") == map.end());
+            assert(!map.try_emplace("bunny", 5).second && map.find("bunny")->second == 2);
+            assert(map.erase("bunny") == 1 && !map.contains("bunny") && map.count("doggy") == 1);
+
+            struct Sale
+            {
+                std::string product;
+                int amount;
+            };
+            std::vector<Sale> sales{ { "tea", 3 }, { "cake", 5 }, { "tea", 4 }, { "scone", 2 }, { "cake", 1 }, { "tea", 2 } };
+            auto product = [](const Sale& s) { return s.product; };
+            auto amount = [](const Sale& s) { return s.amount; };
+
+            // Into a map, one entry per key
+            auto counts = from(sales) >> to_groups(product, aggregate_count());
+            assert(counts.size() == 3 && counts["tea"] == 3 && counts["cake"] == 2 && counts["scone"] == 1);
+
+            auto totals = to_groups(from(sales), product, aggregate_sum(amount));
+            assert(totals["tea"] == 9 && totals["cake"] == 6 && totals["scone"] == 2);
+
+            auto largest = from(sales) >> to_groups(product, aggregate_max(amount));
+            auto smallest = from(sales) >> to_groups(product, aggregate_min(amount));
+            assert(largest["tea"] == 4 && smallest["tea"] == 2 && largest["scone"] == 2 && smallest["cake"] == 1);
+
+            // As an enumerable of pairs, that composes with the other stages
+            using group = std::pair<std::string, int>;
+            auto by_total = from(sales)
+                >> group_by(product, aggregate_sum(amount))
+                >> order_by<group>([](const group& g) { return -g.second; })
+                >> to_vector<group>();
+            assert((by_total == std::vector<group>{ { "tea", 9 }, { "cake", 6 }, { "scone", 2 } }));
+
+            auto cheap = from(sales)
+                >> group_by(product, aggregate_max(amount))
+                >> where([](const group& g) { return g.second < 5; });
+            auto cheap_products = cheap >> select([](const group& g) { return g.first; }) >> to_set<std::string>();
+            assert((cheap_products == FlatHashSet<std::string>{ "tea", "scone" }));
+            assert((cheap >> count()) == 2);
+
+            // Groups of a range, aggregated as the range streams past
+            auto by_remainder = range(0, 1000000)
+                >> group_by([](int i) { return i % 7; }, aggregate_sum([](int i) { return static_cast<long long>(i); }))
+                >> to_vector<std::pair<int, long long>>();
+            assert(by_remainder.size() == 7);
+            long long total = 0;
+            for (const auto& g : by_remainder)
+                total += g.second;
+            assert(total == 999999LL * 1000000LL / 2);
+        }
+
+        TEST_METHOD(GroupByParallel)
+        {
+            using namespace forward;
+            ThreadPool pool(4);
+
+            auto numbers = range(0, 1000000);
+            auto is_kept = [](int i) { return i % 3 != 0; };
+            auto kept = numbers >> where(is_kept);
+            auto sum = aggregate_sum([](int i) { return static_cast<long long>(i); });
+
+            // Few keys, pre-aggregated in every range, and more keys than a range keeps before spilling
+            for (int keys : { 10, 100000 })
+            {
+                auto key = [keys](int i) { return i * 7 % keys; };
+                auto sequential = kept >> to_groups(key, sum);
+                auto parallel_groups = kept >> parallel(pool) >> to_groups(key, sum);
+                assert(parallel_groups.size() == sequential.size() && sequential.size() == static_cast<size_t>(keys));
+                for (const auto& group : sequential)
+                    assert(parallel_groups[group.first] == group.second);
+
+                auto counts = kept >> parallel(pool) >> group_by(key, aggregate_count());
+                auto pairs = counts >> to_vector<std::pair<int, size_t>>();
+                assert(pairs.size() == static_cast<size_t>(keys));
+                size_t total = 0;
+                for (const auto& pair : pairs)
+                    total += pair.second;
+                assert(total == (kept >> count()));
+                assert((counts >> count()) == static_cast<size_t>(keys));
+            }
+
+            // Sources that cannot be split are aggregated sequentially
+            std::list<int> l{ 1, 2, 3, 4, 5 };
+            auto from_l = from(l);
+            auto parities = from_l >> parallel(pool) >> to_groups([](int i) { return i % 2; }, aggregate_max([](int i) { return i; }));
+            assert(parities.size() == 2 && parities[0] == 4 && parities[1] == 5);
+        }
+
+        TEST_METHOD(Join1)
+        {
+            using namespace forward;
+
+            struct User
+            {
+                int id;
+                std::string name;
+            };
+            struct Event
+            {
+                int user;
+                int time;
+            };
+            std::vector<User> users{ { 1, "ann" }, { 2, "bob" }, { 3, "cid" }, { 2, "bea" } };
+            std::vector<Event> events{ { 2, 10 }, { 4, 20 }, { 1, 30 }, { 2, 40 } };
+            auto user_of = [](const Event& e) { return e.user; };
+            auto id = [](const User& u) { return u.id; };
+
+            // In the order of the events, then of the users that share their key
+            using row = std::pair<std::string, int>;
+            auto joined = from(events) >> join(from(users), user_of, id, [](const Event& e, const User& u) { return row(u.name, e.time); });
+            std::vector<row> expected{ { "bob", 10 }, { "bea", 10 }, { "ann", 30 }, { "bob", 40 }, { "bea", 40 } };
+            assert(to_vector(joined) == expected);
+            assert((joined >> to_vector<row>()) == expected);
+
+            auto late = joined
+                >> where([](const row& r) { return r.second > 20; })
+                >> select([](const row& r) { return r.first; })
+                >> to_vector<std::string>();
+            assert((late == std::vector<std::string>{ "ann", "bob", "bea" }));
+
+            // Unique keys are stored in the hash table itself
+            std::vector<User> unique_users{ { 3, "cid" }, { 1, "ann" }, { 2, "bob" } };
+            auto named = from(events) >> join(from(unique_users), user_of, id, [](const Event& e, const User& u) { return row(u.name, e.time); });
+            std::vector<row> expected_named{ { "bob", 10 }, { "ann", 30 }, { "bob", 40 } };
+            assert(to_vector(named) == expected_named);
+            assert((named >> to_vector<row>()) == expected_named);
+
+            // Semi and anti joins keep every outer element once
+            auto known = from(events) >> where_in(from(users), user_of, id) >> select([](const Event& e) { return e.time; });
+            assert((to_vector(known) == std::vector<int>{ 10, 30, 40 }));
+            auto unknown = from(events) >> where_not_in(from(users), user_of, id) >> select([](const Event& e) { return e.time; });
+            assert(((unknown >> to_vector<int>()) == std::vector<int>{ 20 }));
+
+            // The probe side is streamed, so it can be as long as it likes
+            auto squares = range(0, std::numeric_limits<int>::max())
+                >> join(range(0, 100) >> select([](int i) { return i * i; }), [](int i) { return i; }, [](int i) { return i; },
+                    [](int i, int) { return i; })
+                >> take(4);
+            assert((to_vector(squares) == std::vector<int>{ 0, 1, 4, 9 }));
+            auto odd = range(0, std::numeric_limits<int>::max()) >> where_not_in(range(0, 10) >> select([](int i) { return 2 * i; }),
+                [](int i) { return i; }, [](int i) { return i; });
+            assert(((odd >> take(3) >> to_vector<int>()) == std::vector<int>{ 1, 3, 5 }));
+
+            // Empty sides
+            std::vector<User> nobody;
+            assert((from(events) >> join(from(nobody), user_of, id, [](const Event& e, const User&) { return e.time; }) >> count()) == 0);
+            assert((from(events) >> where_not_in(from(nobody), user_of, id) >> count()) == events.size());
+        }
+
+        TEST_METHOD(MergeJoin1)
+        {
+            using namespace forward;
+
+            using reading = std::pair<int, char>;
+            std::vector<reading> left{ { 1, 'a' }, { 2, 'b' }, { 2, 'c' }, { 4, 'd' }, { 5, 'e' }, { 7, 'f' } };
+            std::vector<reading> right{ { 0, 'z' }, { 2, 'y' }, { 2, 'x' }, { 3, 'w' }, { 5, 'v' }, { 8, 'u' } };
+            auto time = [](const reading& r) { return r.first; };
+            auto both = [](const reading& l, const reading& r) { return std::string{ l.second, r.second }; };
+
+            // Duplicate keys on both sides give every pair, in the order of the keys, then of the outer and inner elements
+            auto joined = from(left) >> merge_join(from(right), time, time, both);
+            std::vector<std::string> expected{ "by", "bx", "cy", "cx", "ev" };
+            assert((to_vector(joined) == expected));
+            assert((joined >> to_vector<std::string>()) == expected);
+
+            // The order of order_by and assume_ordered_by is carried to merge_join, which takes its keys from it
+            std::vector<reading> shuffled_left{ left[4], left[1], left[0], left[5], left[3], left[2] };
+            auto ordered = from(shuffled_left) >> order_by<reading>(time);
+            assert((ordered.ordered_key()(left[3]) == 4 && (ordered >> count()) == left.size()));
+            auto tagged = ordered >> merge_join(from(right) >> assume_ordered_by<reading>(time), both);
+            assert((to_vector(tagged) == expected));
+
+            // Empty sides, and no common keys
+            std::vector<reading> none;
+            assert((from(left) >> merge_join(from(none), time, time, both) >> count()) == 0);
+            assert((from(none) >> merge_join(from(right), time, time, both) >> count()) == 0);
+            std::vector<reading> far{ { 100, 'q' } };
+            assert((from(left) >> merge_join(from(far), time, time, both) >> count()) == 0);
+
+            // The end is returned again once the inner elements are exhausted after a match
+            std::vector<reading> first{ { 1, 'q' } };
+            auto ended = from(left) >> merge_join(from(first), time, time, both);
+            auto enumerator = ended.get_enumerator();
+            assert(has_more(enumerator.next()) && !has_more(enumerator.next()) && !has_more(enumerator.next()));
+            assert((from(left) >> merge_join(from(first), time, time, [](const reading&, const reading&) { return 1.0; }) >> take(10) >> sum_from(0.0)) == 1.0);
+
+            // Both sides are streamed, so they can be unbounded
+            auto identity = [](int i) { return i; };
+            auto multiples = range(0, std::numeric_limits<int>::max())
+                >> assume_ordered_by<int>(identity)
+                >> merge_join(range(0, std::numeric_limits<int>::max()) >> select([](int i) { return 3 * (i / 2); }) >> assume_ordered_by<int>(identity),
+                    [](int i, int) { return i; })
+                >> take(5);
+            assert((to_vector(multiples) == std::vector<int>{ 0, 0, 3, 3, 6 }));
+        }
+
+        TEST_METHOD(SelectMany1)
+        {
+            using namespace forward;
+
+            // Containers returned by reference are enumerated in place
+            struct Order
+            {
+                int id;
+                std::vector<int> items;
+            };
+            std::vector<Order> orders{ { 1, { 10, 11 } }, { 2, {} }, { 3, { 30 } }, { 4, { 40, 41, 42 } } };
+            auto items = from(orders) >> select_many([](const Order& o) -> const std::vector<int>& { return o.items; });
+            std::vector<int> expected{ 10, 11, 30, 40, 41, 42 };
+            assert((to_vector(items) == expected));
+            assert((items >> to_vector<int>()) == expected);
+            assert((items >> count()) == 6);
+
+            // Containers returned by value, and enumerables
+            std::vector<std::string> lines{ "a bb", "", "ccc d e" };
+            auto split = [](const std::string& line)
+            {
+                std::vector<std::string> tokens;
+                for (size_t first = 0, last; first < line.size(); first = last + 1)
+                {
+                    last = std::min(line.find(' ', first), line.size());
+                    tokens.push_back(line.substr(first, last - first));
+                }
+                return tokens;
+            };
+            auto tokens = from(lines) >> select_many(split) >> to_vector<std::string>();
+            assert((tokens == std::vector<std::string>{ "a", "bb", "ccc", "d", "e" }));
+
+            auto triangle = range(0, 5) >> select_many([](int i) { return range(0, i); });
+            assert((to_vector(triangle) == std::vector<int>{ 0, 0, 1, 0, 1, 2, 0, 1, 2, 3 }));
+            auto nested = range(0, 3)
+                >> select_many([](int i) { return range(0, i) >> select_many([i](int j) { return std::vector<int>(j + 1, i); }); });
+            assert((to_vector(nested) == std::vector<int>{ 1, 2, 2, 2 }));
+
+            // Copies of an enumerator carry on from the same element
+            auto enumerator = triangle.get_enumerator();
+            enumerator.next();
+            enumerator.next();
+            auto copy = enumerator;
+            auto moved = std::move(enumerator);
+            assert(*copy.next() == 1 && *copy.next() == 0 && *moved.next() == 1 && *moved.next() == 0);
+
+            // Lazily, from an unbounded source
+            auto pairs = range(1, std::numeric_limits<int>::max()) >> select_many([](int i) { return std::vector<int>{ i, -i }; }) >> take(5);
+            assert((to_vector(pairs) == std::vector<int>{ 1, -1, 2, -2, 3 }));
+
+            // Split in ranges of the underlying elements
+            ThreadPool pool(2);
+            auto flattened = range(0, 1000) >> select_many([](int i) { return range(0, i % 10); });
+            auto sequential = flattened >> to_vector<int>();
+            assert((flattened >> parallel(pool) >> to_vector<int>()) == sequential);
+            assert((flattened >> parallel(pool) >> sum_from(0)) == (from(sequential) >> sum_from(0)));
+        }
+
+        TEST_METHOD(DistinctInOrder)
+        {
+            using namespace forward;
+            std::vector<int> v{ 3, 1, 3, 2, 1, 4, 2, 3 };
+
+            // Pushed and pulled, the first occurrences come in the order of the input
+            auto source = from(v);
+            auto distinct_values = source >> distinct<int>();
+            assert((to_vector(distinct_values) == std::vector<int>{ 3, 1, 2, 4 }));
+            std::vector<int> pulled;
+            auto enumerator = distinct_values.get_enumerator();
+            for (auto next = enumerator.next(); has_more(next); next = enumerator.next())
+                pulled.push_back(get_value_by_ref(next));
+            assert((pulled == std::vector<int>{ 3, 1, 2, 4 }));
+
+            // Only as much of the input as needed is pulled
+            int evaluations = 0;
+            auto count = [&](int i) { ++evaluations; return i; };
+            auto counted = source >> select(count);
+            auto first_three = (counted >> distinct<int>()).get_enumerator();
+            for (int i = 0; i < 3; ++i)
+                first_three.next();
+            assert(evaluations == 4);
+
+            auto hint = get_size_hint(distinct_values);
+            assert(hint && hint->size == v.size() && !hint->is_exact);
+        }
+
+        TEST_METHOD(TakeSkip)
+        {
+            using namespace forward;
+            std::vector<int> v{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+            auto source = from(v);
+
+            assert((source >> take(3) >> to_vector<int>()) == (std::vector<int>{ 0, 1, 2 }));
+            assert((source >> skip(7) >> to_vector<int>()) == (std::vector<int>{ 7, 8, 9 }));
+            assert((source >> skip(4) >> take(2) >> to_vector<int>()) == (std::vector<int>{ 4, 5 }));
+            assert((source >> take(20) >> skip(8) >> to_vector<int>()) == (std::vector<int>{ 8, 9 }));
+            assert((source >> skip(20) >> to_vector<int>()).empty());
+            assert((range(0, 100) >> skip(95) >> take(3) >> sum_from(0)) == 95 + 96 + 97);
+
+            // Skipped elements are not transformed, and taking stops pulling
+            int evaluations = 0;
+            auto count = [&](int i) { ++evaluations; return i * 10; };
+            auto counted = source >> select(count);
+            assert((counted >> skip(5) >> take(3) >> to_vector<int>()) == (std::vector<int>{ 50, 60, 70 }));
+            assert(evaluations == 3);
+
+            // Without a skip of their own, filtered elements are pulled
+            int filtered = 0;
+            auto odd = [&](int i) { ++filtered; return i % 2 == 1; };
+            auto odds = source >> where(odd);
+            assert((odds >> skip(1) >> take(2) >> to_vector<int>()) == (std::vector<int>{ 3, 5 }));
+            assert(filtered == 6);
+
+            // Pages of a sorted list, of a non-random access container
+            std::list<int> l(v.begin(), v.end());
+            auto list_source = from(l);
+            assert((list_source >> skip(6) >> take(2) >> to_vector<int>()) == (std::vector<int>{ 6, 7 }));
+
+            auto skipped = source >> skip(2);
+            auto hint = get_size_hint(skipped >> take(5));
+            assert(hint && hint->size == 5 && hint->is_exact);
+            auto odd_hint = get_size_hint(odds >> take(100));
+            assert(odd_hint && odd_hint->size == 10 && !odd_hint->is_exact);
+
+            assert((source >> first<int>()) == 0);
+            assert(!(source >> skip(10) >> first<int>()));
+            assert((source >> skip(9) >> single<int>()) == 9);
+            assert(!(source >> skip(8) >> single<int>()));
+            assert(!(source >> skip(10) >> single<int>()));
+        }
+
+        TEST_METHOD(CountExists)
+        {
+            using namespace forward;
+            std::vector<int> v{ 1, 2, 3, 4, 5, 6 };
+            std::vector<int> none;
+            auto source = from(v);
+
+            // Answered from the size, without transforming anything
+            int evaluations = 0;
+            auto count_calls = [&](int i) { ++evaluations; return i; };
+            auto counted = source >> select(count_calls);
+            assert((counted >> count()) == 6);
+            assert(!(counted >> is_empty()));
+            assert(evaluations == 0);
+            assert((range(0, 1000000) >> count()) == 1000000);
+            assert((from(none) >> is_empty()));
+
+            // Filters are counted by enumerating, and is_empty pulls only until the first element
+            auto even = [](int i) { return i % 2 == 0; };
+            auto evens = source >> where(even);
+            assert((evens >> count()) == 3);
+            auto large = [](int i) { return i > 10; };
+            assert((source >> where(large) >> is_empty()));
+            auto counted_evens = counted >> where(even);
+            assert(!(counted_evens >> is_empty()));
+            assert(evaluations == 2);
+
+            // exists and forall stop at the first decisive element
+            evaluations = 0;
+            assert((counted >> exists([](int i) { return i == 3; })));
+            assert(evaluations == 3);
+            evaluations = 0;
+            assert(!(counted >> forall([](int i) { return i < 2; })));
+            assert(evaluations == 2);
+            assert((source >> forall([](int i) { return i > 0; })));
+            assert(!(source >> exists([](int i) { return i > 6; })));
+            assert((from(none) >> forall([](int) { return false; })));
+        }
+
+        TEST_METHOD(ZipUnzip)
+        {
+            using namespace forward;
+            std::vector<int> numbers{ 1, 2, 3, 4 };
+            std::list<std::string> names{ "one", "two", "three" };
+            auto numbers_source = from(numbers);
+            auto names_source = from(names);
+
+            // Ends with the shortest source, and refers to the elements of iteratables
+            auto zipped = zip(numbers_source, names_source);
+            auto pairs = zipped >> to_vector<std::tuple<const int&, const std::string&>>();
+            assert(pairs.size() == 3);
+            assert(&std::get<0>(pairs[2]) == &numbers[2]);
+            assert(&std::get<1>(pairs[0]) == &names.front());
+            auto hint = get_size_hint(zipped);
+            assert(hint && hint->size == 3 && hint->is_exact);
+
+            // Pulled, and with sources that are not iteratables
+            auto square = [](int i) { return i * i; };
+            auto squares = numbers_source >> select(square);
+            auto indices = range(0, 10);
+            auto with_squares = zip(indices, numbers_source, squares);
+            int pulled = 0;
+            auto enumerator = with_squares.get_enumerator();
+            for (;;)
+            {
+                auto next = enumerator.next();
+                if (!has_more(next))
+                    break;
+                const auto& [index, number, square] = get_value_by_ref(next);
+                assert(number == index + 1 && square == number * number);
+                ++pulled;
+            }
+            assert(pulled == 4);
+
+            // A dot product, sequential and parallel
+            std::vector<double> x{ 1, 2, 3, 4, 5 }, y{ 5, 4, 3, 2, 1 };
+            auto x_source = from(x);
+            auto y_source = from(y);
+            auto products = zip(x_source, y_source);
+            auto multiply = [](const auto& t) { return std::get<0>(t) * std::get<1>(t); };
+            auto multiplied = products >> select(multiply);
+            assert((multiplied >> sum_from(0.0)) == 35);
+            assert(products.source_size() == 5);
+            assert((multiplied >> parallel() >> to_vector<double>()) == (std::vector<double>{ 5, 8, 9, 8, 5 }));
+
+            // Unzipped into a vector per component, or per projection
+            auto [numbers_again, names_again] = zipped >> unzip();
+            assert((numbers_again == std::vector<int>{ 1, 2, 3 }));
+            assert((names_again == std::vector<std::string>{ "one", "two", "three" }));
+
+            auto [sizes, firsts] = names_source >> unzip(
+                [](const std::string& s) { return s.size(); },
+                [](const std::string& s) { return s.front(); });
+            assert((sizes == std::vector<size_t>{ 3, 3, 5 }));
+            assert((firsts == std::vector<char>{ 'o', 't', 't' }));
+        }
+
+        TEST_METHOD(Lines)
+        {
+            using namespace forward;
+            auto path = std::filesystem::temp_directory_path() / "forward-lines-test.txt";
+            {
+                std::ofstream file(path, std::ios::binary);
+                file << "first\n\nthird\r\nfourth, longer\nlast";
+            }
+
+            {
+                auto file_lines = lines(path);
+                auto all = file_lines >> to_vector<std::string_view>();
+                assert((all == std::vector<std::string_view>{ "first", "", "third", "fourth, longer", "last" }));
+
+                std::vector<std::string_view> pulled;
+                auto enumerator = file_lines.get_enumerator();
+                for (auto next = enumerator.next(); has_more(next); next = enumerator.next())
+                    pulled.push_back(get_value_by_ref(next));
+                assert(pulled == all);
+
+                // Every range of bytes pushes the lines that start in it
+                for (size_t split = 0; split <= file_lines.source_size(); ++split)
+                {
+                    std::vector<std::string_view> pushed;
+                    auto sink = [&](std::string_view line) { pushed.push_back(line); };
+                    file_lines.push_range(0, split, sink);
+                    file_lines.push_range(split, file_lines.source_size(), sink);
+                    assert(pushed == all);
+                }
+
+                auto size = [](std::string_view line) { return line.size(); };
+                auto sizes = file_lines >> select(size);
+                assert((sizes >> parallel() >> sum_from(size_t(0))) == 28);
+            }
+
+            // A last end of line does not make an empty line, and empty files have no line
+            {
+                std::ofstream file(path, std::ios::binary);
+                file << "only\n";
+            }
+            assert((lines(path) >> count()) == 1);
+            {
+                std::ofstream file(path, std::ios::binary);
+            }
+            assert((lines(path) >> is_empty()));
+
+            std::filesystem::remove(path);
+
+            bool thrown = false;
+            try
+            {
+                lines(path);
+            }
+            catch (const std::system_error&)
+            {
+                thrown = true;
+            }
+            assert(thrown);
+        }
+
+        TEST_METHOD(Files)
+        {
+            using namespace forward;
+            namespace fs = std::filesystem;
+
+            auto root = fs::temp_directory_path() / "forward-files-test";
+            fs::remove_all(root);
+            fs::create_directories(root / "sub" / "deeper");
+            fs::create_directories(root / "empty");
+            for (const char* name : { "a.txt", "b.log", "sub/c.log", "sub/deeper/d.log" })
+                std::ofstream(root / name) << name;
+
+            auto name = [](const fs::path& path) { return path.filename().string(); };
+            auto names_of = [&](const auto& enumerable)
+            {
+                auto names = enumerable >> select(name) >> to_vector<std::string>();
+                std::sort(names.begin(), names.end());
+                return names;
+            };
+
+            auto top = files(root);
+            auto all = files(root, true);
+            auto all_in_parallel = files(root, true, 4);
+            assert((names_of(top) == std::vector<std::string>{ "a.txt", "b.log" }));
+            assert((names_of(all) == std::vector<std::string>{ "a.txt", "b.log", "c.log", "d.log" }));
+            assert(names_of(all_in_parallel) == names_of(all));
+
+            auto is_log = [](const fs::path& path) { return path.extension() == ".log"; };
+            auto file_size = [](const fs::path& path) { return fs::file_size(path); };
+            auto logs = all_in_parallel >> where(is_log);
+            auto log_sizes = logs >> select(file_size);
+            assert((log_sizes >> sum_from(std::uintmax_t(0))) == 5 + 9 + 16);
+
+            // More files than the queue holds, and a consumer that stops early
+            for (int directory = 0; directory < 4; ++directory)
+            {
+                auto path = root / ("many" + std::to_string(directory));
+                fs::create_directories(path);
+                for (int i = 0; i < 1500; ++i)
+                    std::ofstream(path / (std::to_string(i) + ".txt"));
+            }
+            assert((all_in_parallel >> count()) == 6004);
+            assert((all_in_parallel >> take(10) >> count()) == 10);
+
+            fs::remove_all(root);
+
+            bool thrown = false;
+            try
+            {
+                all_in_parallel >> count();
+            }
+            catch (const fs::filesystem_error&)
+            {
+                thrown = true;
+            }
+            assert(thrown);
+        }
+
+        TEST_METHOD(ShuffleSample)
+        {
+            using namespace forward;
+            auto numbers = range(0, 1000);
+
+            // A permutation, which only depends on the seed
+            auto shuffled = numbers >> shuffle(42) >> to_vector<int>();
+            auto again = numbers >> shuffle(42) >> to_vector<int>();
+            auto other = numbers >> shuffle(43) >> to_vector<int>();
+            assert(shuffled == again && shuffled != other);
+            auto sorted = shuffled;
+            std::sort(sorted.begin(), sorted.end());
+            assert(sorted == (numbers >> to_vector<int>()));
+
+            // The first values of a shuffle are the first values of the complete shuffle
+            auto shuffle_42 = numbers >> shuffle(42);
+            auto first_ten = shuffle_42 >> take(10) >> to_vector<int>();
+            assert(std::equal(first_ten.begin(), first_ten.end(), shuffled.begin()));
+
+            // Samples of distinct elements of the source, or the whole source if it is shorter
+            auto drawn = numbers >> sample<int>(10, 7);
+            assert(drawn.size() == 10);
+            std::sort(drawn.begin(), drawn.end());
+            assert(std::adjacent_find(drawn.begin(), drawn.end()) == drawn.end());
+            assert(drawn.front() >= 0 && drawn.back() < 1000);
+            assert((range(0, 5) >> sample<int>(10, 7)).size() == 5);
+            assert((numbers >> sample<int>(0, 7)).empty());
+
+            // Skips in constant time over ranges: a sample of a billion values is immediate
+            auto huge = range(0LL, 1000000000LL) >> sample<long long>(5, 1);
+            assert(huge.size() == 5);
+            assert(std::count_if(huge.begin(), huge.end(), [](long long i) { return i >= 1000000; }) >= 4);
+
+            // Every element has the same chance to be drawn
+            std::vector<int> hits(10);
+            auto ten = range(0, 10);
+            for (std::uint64_t seed = 0; seed < 10000; ++seed)
+            {
+                for (int i : ten >> sample<int>(3, seed))
+                    ++hits[i];
+            }
+            for (int h : hits)
+                assert(h > 2700 && h < 3300);
+        }
+
+        TEST_METHOD(Reverse1)
+        {
+            using namespace forward;
+
+            // Vectors, lists and ranges are enumerated backwards in place
+            std::vector<int> v{ 1, 2, 3, 4, 5 };
+            auto from_v = from(v);
+            auto reversed = from_v >> reverse();
+            static_assert(std::is_same_v<decltype(reversed)::enumerator, EnumeratorFromIterator<std::reverse_iterator<std::vector<int>::const_iterator>>>);
+            assert((reversed >> to_vector<int>()) == std::vector<int>({ 5, 4, 3, 2, 1 }));
+
+            std::list<int> l{ 1, 2, 3 };
+            auto from_l = from(l);
+            assert((from_l >> reverse() >> to_vector<int>()) == std::vector<int>({ 3, 2, 1 }));
+
+            auto numbers = range(-2, 3);
+            auto reversed_numbers = numbers >> reverse();
+            static_assert(std::is_same_v<decltype(reversed_numbers)::enumerator, ReverseRangeEnumerator<int>>);
+            assert((reversed_numbers >> to_vector<int>()) == std::vector<int>({ 2, 1, 0, -1, -2 }));
+            assert((range(3, 3) >> reverse() >> to_vector<int>()).empty());
+            assert((range(5, 3) >> reverse() >> to_vector<int>()).empty());
+            assert((range(0u, 4u) >> reverse() >> to_vector<unsigned>()) == std::vector<unsigned>({ 3, 2, 1, 0 }));
+
+            // Through where and select
+            auto is_odd = [](int i) { return i % 2 != 0; };
+            auto square = [](int i) { return i * i; };
+            auto odd = from_v >> where(is_odd);
+            auto odd_squares = odd >> select(square);
+            assert((odd_squares >> reverse() >> to_vector<int>()) == std::vector<int>({ 25, 9, 1 }));
+
+            // Take and skip over the reversed enumerator
+            auto last_two = reversed_numbers >> take(2);
+            assert((last_two >> to_vector<int>()) == std::vector<int>({ 2, 1 }));
+            auto but_last_two = reversed_numbers >> skip(2);
+            assert((but_last_two >> to_vector<int>()) == std::vector<int>({ 0, -1, -2 }));
+
+            // Twice gives back the original order
+            auto reversed_twice = reversed >> reverse();
+            static_assert(std::is_same_v<decltype(reversed_twice)::enumerator, EnumeratorFromIterator<std::vector<int>::const_iterator>>);
+            assert((reversed_twice >> to_vector<int>()) == v);
+
+            // Forward-only sources are collected first
+            std::forward_list<std::string> words{ "one", "two", "three" };
+            auto from_words = from(words);
+            auto reversed_words = from_words >> reverse();
+            assert((reversed_words >> to_vector<std::string>()) == std::vector<std::string>({ "three", "two", "one" }));
+            assert((reversed_words >> skip(1) >> to_vector<std::string>()) == std::vector<std::string>({ "two", "one" }));
+        }
+
         TEST_METHOD(OverBy1)
         {
             std::unordered_set<std::string> v{ "caterpillar", "bunny", "doggy", "horsey" };
@@ -199,5 +966,314 @@ namespace forward
                 assert(sorted.back() == "caterpillar");
             }
         }
+
+        TEST_METHOD(NonDefaultConstructible)
+        {
+            using namespace forward;
+
+            struct Labelled
+            {
+                explicit Labelled(std::string label) : label(std::move(label)) {}
+                std::string label;
+            };
+
+            std::vector<Labelled> v{ Labelled("cat"), Labelled("bunny"), Labelled("doggy") };
+
+            auto result =
+                from(v)
+                >> where([](const Labelled& l) { return l.label[0] != 'c'; })
+                >> select([](const Labelled& l) { return Labelled(l.label + "!"); })
+                >> to_vector<Labelled>();
+
+            assert(result.size() == 2);
+            assert(result[0].label == "bunny!");
+            assert(result[1].label == "doggy!");
+        }
+
+        TEST_METHOD(ForEach)
+        {
+            using namespace forward;
+            std::vector<int> v{ 1, 2, 3, 4 };
+
+            int total = 0;
+            from(v)
+                >> where([](int i) { return i % 2 == 1; })
+                >> select([](int i) { return i * 10; })
+                >> for_each([&](int i) { total += i; });
+
+            assert(total == 40);
+        }
+
+        TEST_METHOD(Batches)
+        {
+            using namespace forward;
+
+            auto numbers = range(0, 5000);
+            auto odd = [](int i) { return i % 2 == 1; };
+            auto twice = [](int i) { return i * 2.0; };
+            auto odds = numbers >> where(odd);
+            auto odd_doubles = odds >> select(twice);
+
+            std::vector<double> batched;
+            double buffer[1000];
+            auto enumerator = odd_doubles.get_enumerator();
+            for (size_t count; (count = next_batch(enumerator, buffer, 1000)) != 0;)
+                batched.insert(batched.end(), buffer, buffer + count);
+
+            auto expected = to_vector(odd_doubles);
+            assert(batched == expected);
+            assert(batched.size() == 2500);
+            assert(batched.back() == 9998.0);
+
+            // Only small trivial types are batched, so no element is constructed to fill a buffer
+            std::vector<int> v(5000, 1);
+            Counted::default_constructions = 0;
+            auto counted = from(v) >> select([](int i) { return Counted(i); }) >> where([](const Counted&) { return true; });
+            assert((counted >> take(1) >> to_vector<Counted>()).size() == 1);
+            assert((counted >> take(2) >> select([](const Counted& c) { return c; }) >> to_vector<Counted>()).size() == 2);
+            assert((counted >> skip(4990) >> to_vector<Counted>()).size() == 10);
+            assert(Counted::default_constructions == 0);
+        }
+
+        TEST_METHOD(Parallel)
+        {
+            using namespace forward;
+            ThreadPool pool(4);
+            auto odd = [](int i) { return i % 2 == 1; };
+            auto twice = [](int i) { return static_cast<long long>(i) * 2; };
+
+            auto sequential = range(0, 100001) >> where(odd) >> select(twice) >> to_vector<long long>();
+            auto parallel_vector = range(0, 100001) >> where(odd) >> select(twice) >> parallel(pool) >> to_vector<long long>();
+            assert(parallel_vector == sequential);
+
+            auto sum = range(0, 100001) >> where(odd) >> select(twice) >> parallel(pool) >> sum_from(0LL);
+            assert(sum == 2 * 50000LL * 50000LL);
+
+            // The seed is added once, whatever the number of ranges and threads
+            auto halves = range(0, 100001) >> select([](int i) { return i * 0.5; });
+            assert((range(0, 100) >> parallel(pool) >> sum_from(10)) == (range(0, 100) >> sum_from(10)));
+            assert((halves >> parallel(pool) >> sum_from(10.25)) == (halves >> sum_from(10.25)));
+            assert((halves >> parallel() >> sum_from(-3.0)) == (halves >> sum_from(-3.0)));
+
+            auto set = range(0, 100001) >> select([](int i) { return i % 1000; }) >> parallel() >> to_set<int>();
+            assert(set.size() == 1000);
+
+            std::vector<int> v{ 1, 2, 3, 4, 5, 6, 7 };
+            assert((from(v) >> where(odd) >> parallel(pool) >> to_vector<int>()) == (std::vector<int>{ 1, 3, 5, 7 }));
+
+            // Not splittable: runs sequentially
+            std::list<int> l{ 1, 2, 3, 4, 5, 6, 7 };
+            assert((from(l) >> where(odd) >> parallel(pool) >> sum_from(0)) == 16);
+        }
+
+        TEST_METHOD(ThreadPoolRanges)
+        {
+            using namespace forward;
+            ThreadPool pool(3);
+
+            std::vector<std::atomic<int>> visits(10007);
+            pool.parallel_for(visits.size(), 10, [&](size_t first, size_t last)
+            {
+                assert(first < last && last - first <= 10);
+                for (size_t i = first; i < last; ++i)
+                    ++visits[i];
+            });
+            for (const auto& visit : visits)
+                assert(visit == 1);
+
+            bool thrown = false;
+            try
+            {
+                pool.parallel_for(1000, 1, [](size_t first, size_t) 
+                {
+                    if (first == 500)
+                        throw std::runtime_error("500");
+                });
+            }
+            catch (const std::runtime_error&)
+            {
+                thrown = true;
+            }
+            assert(thrown);
+        }
+
+        TEST_METHOD(SumKernels)
+        {
+            using namespace forward;
+            const int size = 100003;
+
+            std::vector<float> floats(size);
+            std::vector<double> doubles(size);
+            std::vector<int> ints(size);
+            std::vector<long long> longs(size);
+            long long expected = 0;
+            for (int i = 0; i < size; ++i)
+            {
+                floats[i] = static_cast<float>(i % 8);
+                doubles[i] = i % 8;
+                ints[i] = i % 8 - 3;
+                longs[i] = (i % 8) * 1000000000LL;
+                expected += i % 8;
+            }
+
+            assert((from(floats) >> sum_from(0.0f)) == expected);
+            assert((from(doubles) >> sum_from(1.0)) == expected + 1);
+            assert((from(ints) >> sum_from(0)) == expected - 3LL * size);
+            assert((from(longs) >> sum_from(0LL)) == expected * 1000000000LL);
+
+            // Batches
+            auto eighths = [](int i) { return (i % 8) / 8.0; };
+            auto numbers = range(0, size);
+            assert((numbers >> select(eighths) >> sum_from(0.0)) == expected / 8.0);
+
+            // Closed form
+            assert((range(-5, 100000) >> sum_from(0LL)) == 99999LL * 100000 / 2 - 15);
+            assert((range(7, 7) >> sum_from(3)) == 3);
+            unsigned wrapped = 10;
+            for (unsigned i = 100; i < 200000; ++i)
+                wrapped += i;
+            assert((range(100u, 200000u) >> sum_from(10u)) == wrapped);
+
+            // Ranges wider than the largest value of their type
+            const int lowest = std::numeric_limits<int>::min(), highest = std::numeric_limits<int>::max();
+            auto wide = range(lowest, highest);
+            assert(get_size_hint(wide)->size == size_t(std::numeric_limits<unsigned>::max()));
+            size_t all_but_three = size_t(std::numeric_limits<unsigned>::max()) - 3;
+            assert(((wide >> skip(all_but_three) >> to_vector<int>()) == std::vector<int>{ highest - 3, highest - 2, highest - 1 }));
+            assert(((wide >> reverse() >> skip(all_but_three) >> to_vector<int>()) == std::vector<int>{ lowest + 2, lowest + 1, lowest }));
+        }
+
+        TEST_METHOD(SizeHints)
+        {
+            using namespace forward;
+            std::vector<std::string> v{ "cat", "bunny", "doggy", "horsey" };
+            auto size = [](const std::string& s) { return s.size(); };
+            auto short_word = [](const std::string& s) { return s.size() < 4; };
+
+            auto hint = get_size_hint(from(v) >> select(size));
+            assert(hint && hint->is_exact && hint->size == 4);
+
+            hint = get_size_hint(from(v) >> where(short_word));
+            assert(hint && !hint->is_exact && hint->size == 4);
+
+            hint = get_size_hint(range(3, 10));
+            assert(hint && hint->is_exact && hint->size == 7);
+
+            std::forward_list<int> unsized{ 1, 2, 3 };
+            assert(!get_size_hint(from(unsized)));
+            assert(!get_size_hint(from(unsized) >> take(size_t(1) << 40)));
+            auto taken = from(unsized) >> take(size_t(1) << 40) >> to_vector<int>();
+            assert(taken.size() == 3 && taken.capacity() < 100);
+
+            auto sizes = from(v) >> select(size) >> to_vector<size_t>();
+            assert(sizes.capacity() == 4);
+
+            // Upper bounds are not reserved
+            std::vector<int> large(1000000);
+            auto rare = from(large) >> where([](int i) { return i != 0; });
+            assert((rare >> to_vector<int>()).capacity() == 0);
+            assert(std::get<0>(zip(rare, rare) >> unzip()).capacity() == 0);
+            assert((rare >> to_unordered_set<int>()).bucket_count() < 1000);
+        }
+
+        TEST_METHOD(OrderByCachedKeys)
+        {
+            using namespace forward;
+            std::vector<std::string> v{ "ccc", "a", "bb", "dddd", "e", "ff" };
+
+            int evaluations = 0;
+            auto counted_size = [&](const std::string& s) { ++evaluations; return s.size(); };
+            auto sorted = from(v) >> to_vector_ordered_by<std::string>(counted_size);
+
+            // Evaluated once per element, and stable between equal keys
+            assert(evaluations == 6);
+            assert((sorted == std::vector<std::string>{ "a", "e", "bb", "ff", "ccc", "dddd" }));
+
+            // Keys returned by reference
+            auto itself = [](const std::string& s) -> const std::string& { return s; };
+            auto alphabetical = from(v) >> order_by<std::string>(itself) >> to_vector<std::string>();
+            assert((alphabetical == std::vector<std::string>{ "a", "bb", "ccc", "dddd", "e", "ff" }));
+
+            // Non-scalar keys of scalar values are evaluated once per element too
+            std::vector<int> indices{ 2, 0, 5, 1, 3, 4 };
+            evaluations = 0;
+            auto counted_name = [&](int i) { ++evaluations; return v[i]; };
+            auto by_name = from(indices) >> to_vector_ordered_by<int>(counted_name);
+            assert(evaluations == 6);
+            assert((by_name == std::vector<int>{ 1, 2, 0, 3, 4, 5 }));
+        }
+
+        TEST_METHOD(TopK)
+        {
+            using namespace forward;
+            std::vector<std::string> v{ "ccc", "a", "bb", "dddd", "e", "ff", "g", "hhh" };
+            auto size = [](const std::string& s) { return s.size(); };
+            auto source = from(v);
+
+            // The same elements as ordering then taking, stable between equal keys
+            for (size_t k : { 0, 1, 3, 4, 8, 20 })
+            {
+                auto ordered = source >> order_by<std::string>(size);
+                auto expected = ordered >> take(k) >> to_vector<std::string>();
+                assert((source >> top_k<std::string>(k, size)) == expected);
+            }
+
+            // Highest scores first, over a stream much longer than k
+            auto negated = [](int i) { return -((i * 37) % 101); };
+            auto numbers = range(0, 10000);
+            auto best = numbers >> top_k<int>(150, negated);
+            auto ordered = numbers >> order_by<int>(negated);
+            assert(best == (ordered >> take(150) >> to_vector<int>()));
+            assert(negated(best.front()) == -100 && negated(best.back()) == -99);
+
+            // A k far beyond a source without a size hint reserves nothing upfront
+            std::forward_list<int> list{ 3, 1, 2 };
+            auto identity = [](int i) { return i; };
+            assert((from(list) >> top_k<int>(size_t(1) << 60, identity)) == (std::vector<int>{ 1, 2, 3 }));
+        }
+
+        TEST_METHOD(OrderByRadix)
+        {
+            using namespace forward;
+
+            // Compared with a stable comparison sort, on keys spanning negative, zero and large values
+            auto check = [](const auto& v, auto key)
+            {
+                using T = typename std::decay_t<decltype(v)>::value_type;
+                auto expected = v;
+                std::stable_sort(expected.begin(), expected.end(), [&](const T& a, const T& b) { return key(a) < key(b); });
+                auto sorted = from(v) >> to_vector_ordered_by<T>(key);
+                assert(sorted == expected);
+            };
+
+            std::vector<int> integers;
+            for (int i = 0; i < 1000; ++i)
+                integers.push_back((i * 7919) % 2003 - 1000 + (i % 5 == 0 ? 1 << 30 : 0));
+            check(integers, [](int i) { return i; });
+            check(integers, [](int i) { return static_cast<unsigned char>(i); });
+            check(integers, [](int i) { return static_cast<long long>(i) * -3; });
+            check(integers, [](int i) { return static_cast<unsigned long long>(i) << 20; });
+
+            std::vector<double> reals{ 3.5, -0.0, -2.25, 1e300, 0.0, -1e-300, 7.0, -1e300, 0.5, -2.25, 1e-300 };
+            check(reals, [](double d) { return d; });
+            check(reals, [](double d) { return static_cast<float>(-d); });
+
+            // Tuples, including equal keys that must keep their order
+            std::vector<std::pair<int, float>> pairs;
+            for (int i = 0; i < 500; ++i)
+                pairs.emplace_back(i % 7 - 3, static_cast<float>(i % 11) - 5.5f);
+            check(pairs, [](const std::pair<int, float>& p) { return std::make_tuple(p.first, -p.second); });
+            check(pairs, [](const std::pair<int, float>& p) { return std::make_pair(p.second, p.first % 2); });
+            check(pairs, [](const std::pair<int, float>& p) { return p.first; });
+
+            // Nested pairs and tuples are sorted by comparisons
+            static_assert(!details::is_radix_sortable<std::pair<std::pair<int, int>, int>>::value, "Oops.");
+            check(pairs, [](const std::pair<int, float>& p) { return std::make_pair(std::make_pair(p.first % 2, p.second), p.first); });
+            check(pairs, [](const std::pair<int, float>& p) { return std::make_tuple(p.second, std::make_tuple(p.first)); });
+            auto nested = from(pairs)
+                >> order_by<std::pair<int, float>>([](const std::pair<int, float>& p) { return std::make_pair(std::make_pair(p.second, p.first), 0); })
+                >> to_vector<std::pair<int, float>>();
+            assert(std::is_sorted(nested.begin(), nested.end(), [](const auto& a, const auto& b) { return std::tie(a.second, a.first) < std::tie(b.second, b.first); }));
+        }
     };
 }
\ No newline at end of file